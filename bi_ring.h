@@ -1,36 +1,134 @@
 #ifndef LAB2_BI_RING_H
 #define LAB2_BI_RING_H
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <iostream>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "bi_ring_numa.h"
+#if __has_include(<span>)
+#include <span>
+#endif
 
 using namespace std;
 
+// Checked iterators validate every hop and access: null, stale after erase, used with
+// a different ring. Unchecked ones compile to raw pointer hops. Checking adds a field to
+// every node, so all translation units of a program must agree on the setting. It has
+// no default for that reason, define it to 1 or 0 for the whole build as CMake does.
+#ifndef BI_RING_CHECKED_ITERATORS
+#error "Define BI_RING_CHECKED_ITERATORS to 1 or 0, the same for every translation unit"
+#endif
+
+// whether std::hash can hash T
+template <typename T, typename = void>
+struct bi_ring_hashable : false_type {};
+
+template <typename T>
+struct bi_ring_hashable<T, void_t<decltype(hash<T>()(declval<const T &>()))>> : true_type {};
+
 template <typename Key, typename Info>
 class bi_ring {
+public:
+    class node_pool;
+
 private:
+    struct node_block;
+
     class Node {
     private:
         Node* prev;
         Node* next;
+        node_block* block;
+#if BI_RING_CHECKED_ITERATORS
+        // ring the node is linked into, nullptr once erased
+        const bi_ring *owner = nullptr;
+#endif
     public:
         Key key;
         Info info;
 
-        Node(const Key &key, const Info &info, Node *next, Node *prev): key(key), info(info), next(next), prev(prev){}
+        Node(const Key &key, const Info &info, Node *next, Node *prev): prev(prev), next(next), block(nullptr), key(key), info(info){}
+        Node(Key &&key, Info &&info, Node *next, Node *prev): prev(prev), next(next), block(nullptr), key(std::move(key)), info(std::move(info)){}
 
         friend  class bi_ring;
     };
 
-    template<typename KeyT, typename InfoT, typename Ring>
+    /**
+     * Header of a contiguous chunk of node slots. The slots follow the header in memory.
+     * live counts slots that are either holding a node or waiting on a free list,
+     * the chunk is released when it drops to zero. Spliced nodes may end up in rings
+     * owned by other threads, so the counter is atomic.
+     */
+    struct alignas(Node) node_block {
+        atomic<unsigned int> live;
+        // pool the block was carved for, nullptr for blocks owned by rings
+        node_pool *pool = nullptr;
+
+        Node *slots(){
+            return reinterpret_cast<Node *>(this + 1);
+        }
+    };
+
+    /**
+     * Free slot of a node_block, placed in the storage of a destroyed node.
+     */
+    struct free_slot {
+        free_slot *next;
+        node_block *block;
+    };
+
+    // batches up to this size are probed by comparing against every key, bigger ones by hash
+    static const unsigned int linear_probe_limit = 16;
+
+#if BI_RING_CHECKED_ITERATORS
+    // how many erased nodes are kept alive so stale iterators can be detected
+    static const unsigned int quarantine_size = 64;
+#endif
+
+    /**
+     * Iterator over the ring. With Wrap, ++ and -- jump over the sentinel so the iterator
+     * goes round the ring forever; without it they are plain hops like next() and prev().
+     */
+    template<typename KeyT, typename InfoT, typename Ring, bool Wrap = true>
     class iterator {
     private:
         friend class bi_ring;
+        template<typename, typename, typename, bool> friend class iterator;
 
         Node *ptr;
         const Ring *ring;
 
         iterator(Node *ptr, const Ring *ring): ptr(ptr), ring(ring) {}
 
+        void check() const{
+#if BI_RING_CHECKED_ITERATORS
+            if(ptr == nullptr){
+                throw runtime_error("Iterator is null");
+            }
+            if(ptr->owner != ring){
+                throw runtime_error("Iterator is invalidated");
+            }
+#endif
+        }
+
     public:
+        // modifying iterators convert to constant ones, not the other way round,
+        // wrapping and raw iterators convert to each other
+        template<typename K, typename I, bool W, typename = enable_if_t<is_same<const K, const KeyT>::value
+                && (is_const<KeyT>::value || !is_const<K>::value) && !(is_same<K, KeyT>::value && W == Wrap)>>
+        iterator(const iterator<K, I, Ring, W> &other): ptr(other.ptr), ring(other.ring) {}
+
+        // null iterator, a placeholder until one is assigned, using it throws in checked builds
+        iterator(): ptr(nullptr), ring(nullptr) {}
+
+        iterator(const iterator &other) = default;
+
         bool operator==(const iterator &other) const{
             return  ptr == other.ptr;
         }
@@ -42,6 +140,7 @@ private:
         iterator &operator=(const iterator &src){
             if(this != &src){
                 ptr = src.ptr;
+                ring = src.ring;
             }
             return *this;
         }
@@ -64,7 +163,7 @@ private:
 
         iterator operator++(){
             next();
-            if(ptr == ring->sentinel){
+            if(Wrap && ptr == ring->sentinel){
                 next();
             }
             return *this;
@@ -72,16 +171,13 @@ private:
 
         iterator operator++(int){
             iterator temp = *this;
-            next();
-            if(ptr == ring->sentinel){
-                next();
-            }
+            ++*this;
             return temp;
         }
 
         iterator operator--(){
             prev();
-            if(ptr == ring->sentinel){
+            if(Wrap && ptr == ring->sentinel){
                 prev();
             }
             return *this;
@@ -89,76 +185,678 @@ private:
 
         iterator operator--(int){
             iterator temp = *this;
-            prev();
-            if(ptr == ring->sentinel){
-                prev();
-            }
+            --*this;
             return temp;
         }
 
         iterator next(){
-            if(ptr == nullptr){
-                throw runtime_error("Iterator is null");
-            }
+            check();
             ptr = ptr->next;
             return *this;
         }
 
         iterator get_next(){
-            if(ptr == nullptr){
-                throw runtime_error("Iterator is null");
-            }
+            check();
             return iterator(ptr->next, ring);
         }
 
         iterator prev(){
-            if(ptr == nullptr){
-                throw runtime_error("Iterator is null");
-            }
+            check();
             ptr = ptr->prev;
             return *this;
         }
 
         iterator get_prev(){
-            if(ptr == nullptr){
-                throw runtime_error("Iterator is null");
-            }
+            check();
             return iterator(ptr->prev, ring);
         }
 
         KeyT &key() const{
+            check();
+            modifiable();
             return ptr->key;
         }
 
         InfoT &info() const{
+            check();
+            modifiable();
             return ptr->info;
         }
+
+    private:
+        // a modifying iterator hands out a writable element, so the fingerprint can no
+        // longer be trusted; constant iterators leave the ring untouched
+        void modifiable() const{
+            if constexpr (!is_const<KeyT>::value && Ring::fingerprinted){
+                ring->content_stale = true;
+            }
+        }
     };
 
     unsigned int length;
 
     Node* sentinel;
 
+    free_slot *free_slots;
+    unsigned int free_count;
+
+    node_pool *pool;
+
+    static constexpr bool fingerprinted = bi_ring_hashable<Key>::value && bi_ring_hashable<Info>::value;
+
+    // polynomial hash of the content, sum of element_hash * base^rank modulo 2^61 - 1,
+    // and base^length. Changes at either end keep it current, anything else marks it
+    // stale until fingerprint() rehashes the ring. Written by the const fingerprint(),
+    // which therefore needs exclusive access when the hash is stale.
+    mutable uint64_t content_hash = 0;
+    mutable uint64_t content_power = 1;
+    mutable bool content_stale = false;
+
+#if BI_RING_CHECKED_ITERATORS
+    // recently erased nodes, oldest first, linked through next
+    Node *quarantine_head = nullptr;
+    Node *quarantine_tail = nullptr;
+    unsigned int quarantine_count = 0;
+#endif
+
+    void adopt(Node *node) const{
+#if BI_RING_CHECKED_ITERATORS
+        node->owner = this;
+#else
+        (void)node;
+#endif
+    }
+
+    template <typename iterator>
+    void check_position(const iterator &position) const{
+#if BI_RING_CHECKED_ITERATORS
+        if (position.ring != this){
+            throw runtime_error("Iterator belongs to a different ring");
+        }
+        position.check();
+#else
+        (void)position;
+#endif
+    }
+
+    static constexpr uint64_t hash_modulus = (1ULL << 61) - 1;
+    static constexpr uint64_t hash_base = 0x0d1b54a32d192ed3ULL;
+
+    static uint64_t hash_reduce(uint64_t x){
+        x = (x >> 61) + (x & hash_modulus);
+        return x >= hash_modulus ? x - hash_modulus : x;
+    }
+
+    // a * b modulo 2^61 - 1 for a, b below the modulus, without 128 bit integers
+    static uint64_t hash_multiply(uint64_t a, uint64_t b){
+        const uint64_t mask30 = (1ULL << 30) - 1;
+        const uint64_t mask31 = (1ULL << 31) - 1;
+        uint64_t au = a >> 31;
+        uint64_t ad = a & mask31;
+        uint64_t bu = b >> 31;
+        uint64_t bd = b & mask31;
+        uint64_t mid = ad * bu + au * bd;
+        return hash_reduce(au * bu * 2 + (mid >> 30) + ((mid & mask30) << 31) + ad * bd);
+    }
+
+    static uint64_t hash_add(uint64_t a, uint64_t b){
+        return hash_reduce(a + b);
+    }
+
+    static uint64_t hash_subtract(uint64_t a, uint64_t b){
+        return hash_reduce(a + hash_modulus - b);
+    }
+
+    // base^-1, by Fermat base^(modulus - 2)
+    static uint64_t hash_inverse_base(){
+        static const uint64_t inverse = []{
+            uint64_t result = 1;
+            uint64_t power = hash_base;
+            for (uint64_t exponent = hash_modulus - 2; exponent != 0; exponent >>= 1){
+                if (exponent & 1){
+                    result = hash_multiply(result, power);
+                }
+                power = hash_multiply(power, power);
+            }
+            return result;
+        }();
+        return inverse;
+    }
+
+    static uint64_t element_hash(const Node *node){
+        uint64_t h = hash<Key>()(node->key);
+        h ^= hash<Info>()(node->info) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return h % (hash_modulus - 1) + 1;
+    }
+
+    /**
+     * Updates the fingerprint after node got linked into the ring.
+     */
+    void hash_linked(const Node *node){
+        if constexpr (fingerprinted){
+            if (content_stale){
+                return;
+            }
+            if (node->next == sentinel){
+                content_hash = hash_add(content_hash, hash_multiply(element_hash(node), content_power));
+            }
+            else if (node->prev == sentinel){
+                content_hash = hash_add(element_hash(node), hash_multiply(content_hash, hash_base));
+            }
+            else {
+                content_stale = true;
+                return;
+            }
+            content_power = hash_multiply(content_power, hash_base);
+        }
+        else {
+            (void)node;
+        }
+    }
+
+    /**
+     * Updates the fingerprint before node gets unlinked from the ring.
+     */
+    void hash_unlinking(const Node *node){
+        if constexpr (fingerprinted){
+            if (content_stale){
+                return;
+            }
+            if (node->next == sentinel){
+                content_power = hash_multiply(content_power, hash_inverse_base());
+                content_hash = hash_subtract(content_hash, hash_multiply(element_hash(node), content_power));
+            }
+            else if (node->prev == sentinel){
+                content_hash = hash_multiply(hash_subtract(content_hash, element_hash(node)), hash_inverse_base());
+                content_power = hash_multiply(content_power, hash_inverse_base());
+            }
+            else {
+                content_stale = true;
+            }
+        }
+        else {
+            (void)node;
+        }
+    }
+
+    void reset_content_hash(){
+        content_hash = 0;
+        content_power = 1;
+        content_stale = false;
+    }
+
+    static node_block *allocate_block(unsigned int count){
+        auto *block = new (::operator new(sizeof(node_block) + count * sizeof(Node))) node_block;
+        block->live = count;
+        return block;
+    }
+
+    static void release_slot(node_block *block){
+        if (--block->live == 0){
+            block->~node_block();
+            ::operator delete(block);
+        }
+    }
+
+    void release_free_slots(){
+        while (free_slots != nullptr){
+            free_slot *slot = free_slots;
+            free_slots = slot->next;
+            if (slot->block->pool != nullptr){
+                slot->block->pool->release(slot);
+            }
+            else {
+                release_slot(slot->block);
+            }
+        }
+        free_count = 0;
+    }
+
+    /**
+     * Allocates a node, reusing a free slot of a node_block when there is one.
+     * Rings with a pool take their slots from the pool instead of the heap.
+     */
+    Node *create_node(const Key &key, const Info &info){
+        if (free_slots == nullptr && pool != nullptr){
+            free_slots = pool->acquire();
+            free_slots->next = nullptr;
+            free_count++;
+        }
+        if (free_slots == nullptr){
+            Node *node = new Node(key, info, nullptr, nullptr);
+            adopt(node);
+            return node;
+        }
+
+        free_slot *slot = free_slots;
+        free_slot *rest = slot->next;
+        node_block *block = slot->block;
+        Node *node;
+        try {
+            node = new (slot) Node(key, info, nullptr, nullptr);
+        } catch (...) {
+            new (slot) free_slot{rest, block};
+            throw;
+        }
+        node->block = block;
+        adopt(node);
+        free_slots = rest;
+        free_count--;
+        return node;
+    }
+
+    /**
+     * Frees an erased node. Checked builds clear its owner, so iterators still pointing
+     * on it throw. Slots of node blocks go back to the free list right away and keep the
+     * cleared owner until reused. Heap nodes have key and info destroyed and their raw
+     * storage kept in a quarantine for the last erases, instead of being freed at once.
+     */
+    void destroy_node(Node *node){
+#if BI_RING_CHECKED_ITERATORS
+        node->owner = nullptr;
+        if (node->block != nullptr){
+            release_node(node);
+            return;
+        }
+        node->key.~Key();
+        node->info.~Info();
+        node->next = nullptr;
+        if (quarantine_tail == nullptr){
+            quarantine_head = node;
+        }
+        else {
+            quarantine_tail->next = node;
+        }
+        quarantine_tail = node;
+        if (++quarantine_count > quarantine_size){
+            Node *oldest = quarantine_head;
+            quarantine_head = oldest->next;
+            quarantine_count--;
+            ::operator delete(oldest);
+        }
+#else
+        release_node(node);
+#endif
+    }
+
+    void release_quarantine(){
+#if BI_RING_CHECKED_ITERATORS
+        while (quarantine_head != nullptr){
+            Node *oldest = quarantine_head;
+            quarantine_head = oldest->next;
+            // key and info were destroyed by destroy_node, only the storage is left
+            ::operator delete(oldest);
+        }
+        quarantine_tail = nullptr;
+        quarantine_count = 0;
+#endif
+    }
+
+    void release_node(Node *node){
+        node_block *block = node->block;
+        if (block == nullptr){
+            delete node;
+            return;
+        }
+        node->~Node();
+        if (block->pool != nullptr){
+            block->pool->release(new (node) free_slot{nullptr, block});
+            return;
+        }
+        free_slots = new (node) free_slot{free_slots, block};
+        free_count++;
+    }
+
+    /**
+     * Walks the ring once matching every node against a batch of keys. slots maps each
+     * key of the batch to the index of its distinct key and distinct is set to their
+     * number before the walk. found is called with that index and the node and returns
+     * false to stop the walk early.
+     */
+    template <typename Found>
+    void probe_keys(const Key *keys, size_t count, vector<size_t> &slots, size_t &distinct, Found found) const
+    {
+        slots.resize(count);
+
+        if constexpr (bi_ring_hashable<Key>::value)
+        {
+            if (count > linear_probe_limit)
+            {
+                unordered_map<Key, size_t> index;
+                index.reserve(count);
+                for (size_t i = 0; i < count; i++)
+                {
+                    slots[i] = index.emplace(keys[i], index.size()).first->second;
+                }
+                distinct = index.size();
+                for (Node *node = sentinel->next; node != sentinel; node = node->next)
+                {
+                    auto hit = index.find(node->key);
+                    if (hit != index.end() && !found(hit->second, node))
+                    {
+                        break;
+                    }
+                }
+                return;
+            }
+        }
+
+        // small batches: a scan over a contiguous copy of the distinct keys
+        vector<Key> probes;
+        probes.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t slot = 0;
+            while (slot < probes.size() && !(probes[slot] == keys[i]))
+            {
+                slot++;
+            }
+            if (slot == probes.size())
+            {
+                probes.push_back(keys[i]);
+            }
+            slots[i] = slot;
+        }
+        distinct = probes.size();
+        for (Node *node = sentinel->next; node != sentinel; node = node->next)
+        {
+            for (size_t slot = 0; slot < probes.size(); slot++)
+            {
+                if (probes[slot] == node->key)
+                {
+                    if (!found(slot, node))
+                    {
+                        return;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
 public:
+    /**
+     * Node allocator bound to one NUMA node, shared by any number of rings and threads.
+     * Every thread keeps a cache of free slots per pool it uses, refilled from
+     * and returned to the pool in batches, so most allocations and erases take no lock.
+     * Nodes keep the pool they came from when spliced into other rings.
+     *
+     * A pool has to outlive the rings using it and the threads must have exited or
+     * called flush() before it is destroyed. Pools from for_node() live forever.
+     */
+    class node_pool {
+    private:
+        friend class bi_ring;
+
+        struct thread_cache {
+            node_pool *pool;
+            free_slot *slots;
+            unsigned int count;
+
+            void flush(){
+                if (count > 0){
+                    pool->give_back(*this, count);
+                }
+            }
+        };
+
+        // caches of every pool the thread used, returned to their pools when it exits
+        struct thread_caches {
+            vector<thread_cache> caches;
+
+            ~thread_caches(){
+                for (thread_cache &cache : caches){
+                    cache.flush();
+                }
+            }
+
+            thread_cache *find(const node_pool *pool){
+                for (thread_cache &cache : caches){
+                    if (cache.pool == pool){
+                        return &cache;
+                    }
+                }
+                return nullptr;
+            }
+
+            void remove(const node_pool *pool){
+                thread_cache *cache = find(pool);
+                if (cache != nullptr){
+                    *cache = caches.back();
+                    caches.pop_back();
+                }
+            }
+        };
+
+        static thread_caches &local_caches(){
+            static thread_local thread_caches caches;
+            return caches;
+        }
+
+        // the calling thread's cache of this pool, created on first use
+        thread_cache &local_cache(){
+            thread_caches &caches = local_caches();
+            thread_cache *cache = caches.find(this);
+            if (cache == nullptr){
+                caches.caches.push_back(thread_cache{this, nullptr, 0});
+                cache = &caches.caches.back();
+            }
+            return *cache;
+        }
+
+        int numa_node;
+        unsigned int batch;
+
+        // memory is mapped in chunks of about this size and batches are carved from them,
+        // so one allocation and mbind call serve many refills
+        static const size_t chunk_bytes = size_t(4) << 20;
+
+        struct chunk {
+            void *memory;
+            size_t bytes;
+        };
+
+        mutable mutex lock;
+        free_slot *shared;
+        size_t shared_count;
+        vector<chunk> chunks;
+        // uncarved rest of the newest chunk, in blocks
+        char *carve_next;
+        size_t carve_left;
+        size_t carved;
+
+        size_t block_bytes() const{
+            return sizeof(node_block) + batch * sizeof(Node);
+        }
+
+        node_block *carve_block(){
+            if (carve_left == 0){
+                size_t count = max<size_t>(1, chunk_bytes / block_bytes());
+                chunk fresh{bi_ring_numa_allocate(count * block_bytes(), numa_node), count * block_bytes()};
+                chunks.push_back(fresh);
+                carve_next = static_cast<char *>(fresh.memory);
+                carve_left = count;
+            }
+            auto *block = new (carve_next) node_block;
+            carve_next += block_bytes();
+            carve_left--;
+            carved++;
+            return block;
+        }
+
+        // moves count slots from the front of the cache to the shared list
+        void give_back(thread_cache &cache, unsigned int count){
+            free_slot *first = cache.slots;
+            free_slot *last = first;
+            for (unsigned int i = 1; i < count; i++){
+                last = last->next;
+            }
+            cache.slots = last->next;
+            cache.count -= count;
+
+            lock_guard<mutex> guard(lock);
+            last->next = shared;
+            shared = first;
+            shared_count += count;
+        }
+
+        void refill(thread_cache &cache){
+            lock_guard<mutex> guard(lock);
+            if (shared_count < batch){
+                node_block *block = carve_block();
+                block->live = batch;
+                block->pool = this;
+
+                Node *slots = block->slots();
+                for (unsigned int i = batch; i > 0; i--){
+                    shared = new (&slots[i - 1]) free_slot{shared, block};
+                }
+                shared_count += batch;
+            }
+
+            for (unsigned int i = 0; i < batch; i++){
+                free_slot *slot = shared;
+                shared = slot->next;
+                slot->next = cache.slots;
+                cache.slots = slot;
+            }
+            shared_count -= batch;
+            cache.count += batch;
+        }
+
+        free_slot *acquire(){
+            thread_cache &cache = local_cache();
+            if (cache.slots == nullptr){
+                refill(cache);
+            }
+            free_slot *slot = cache.slots;
+            cache.slots = slot->next;
+            cache.count--;
+            return slot;
+        }
+
+        void release(free_slot *slot){
+            thread_cache &cache = local_cache();
+            slot->next = cache.slots;
+            cache.slots = slot;
+            if (++cache.count >= 2 * batch){
+                give_back(cache, batch);
+            }
+        }
+
+    public:
+        /**
+         * @param numa_node node the memory is bound to, negative keeps the default placement
+         * @param batch number of slots moved between the pool and a thread cache at once
+         */
+        explicit node_pool(int numa_node = -1, unsigned int batch = 64)
+            : numa_node(numa_node), batch(batch == 0 ? 1 : batch), shared(nullptr), shared_count(0),
+              carve_next(nullptr), carve_left(0), carved(0) {}
+
+        node_pool(const node_pool &) = delete;
+        node_pool &operator=(const node_pool &) = delete;
+
+        ~node_pool(){
+            static_assert(is_trivially_destructible<node_block>::value, "carved blocks are not destroyed one by one");
+            local_caches().remove(this);
+            for (const chunk &mapped : chunks){
+                bi_ring_numa_deallocate(mapped.memory, mapped.bytes, numa_node);
+            }
+        }
+
+        /**
+         * @brief process wide pool of a NUMA node, created on first use and never freed
+         */
+        static node_pool &for_node(int numa_node){
+            static mutex pools_lock;
+            // never destroyed, thread caches may flush into these pools during exit
+            static auto *pools = new unordered_map<int, node_pool *>();
+
+            lock_guard<mutex> guard(pools_lock);
+            node_pool *&found = (*pools)[numa_node];
+            if (found == nullptr){
+                found = new node_pool(numa_node);
+            }
+            return *found;
+        }
+
+        [[nodiscard]] int node() const{
+            return numa_node;
+        }
+
+        // slots carved from the mapped chunks so far, in use or free
+        [[nodiscard]] size_t capacity() const{
+            lock_guard<mutex> guard(lock);
+            return carved * batch;
+        }
+
+        // bytes of memory mapped for the pool
+        [[nodiscard]] size_t mapped_bytes() const{
+            lock_guard<mutex> guard(lock);
+            size_t bytes = 0;
+            for (const chunk &mapped : chunks){
+                bytes += mapped.bytes;
+            }
+            return bytes;
+        }
+
+        // free slots in the shared list, not counting thread caches
+        [[nodiscard]] size_t pooled() const{
+            lock_guard<mutex> guard(lock);
+            return shared_count;
+        }
+
+        // free slots in the calling thread's cache
+        [[nodiscard]] unsigned int cached() const{
+            thread_cache *cache = local_caches().find(this);
+            return cache == nullptr ? 0 : cache->count;
+        }
+
+        /**
+         * @brief returns the calling thread's cache to the pool
+         */
+        void flush(){
+            thread_cache *cache = local_caches().find(this);
+            if (cache != nullptr){
+                cache->flush();
+                local_caches().remove(this);
+            }
+        }
+    };
+
     typedef iterator<Key, Info, bi_ring> mod_iterator;
     typedef iterator<const Key, const Info, bi_ring> const_iterator;
+    typedef iterator<Key, Info, bi_ring, false> mod_raw_iterator;
+    typedef iterator<const Key, const Info, bi_ring, false> const_raw_iterator;
 
-    bi_ring() : length(0)
+    bi_ring() : length(0), free_slots(nullptr), free_count(0), pool(nullptr)
     {
         sentinel = new Node(Key(), Info(), nullptr, nullptr);
         sentinel->next = sentinel;
         sentinel->prev = sentinel;
+        adopt(sentinel);
+    }
+    /**
+     * @brief creates an empty ring allocating its nodes from pool
+     */
+    explicit bi_ring(node_pool &pool) : bi_ring()
+    {
+        this->pool = &pool;
     }
-    bi_ring(const bi_ring &src) : length(0)
+    // copies allocate from the same pool as src
+    bi_ring(const bi_ring &src) : length(0), free_slots(nullptr), free_count(0), pool(src.pool)
     {
         sentinel = new Node(Key(), Info(), nullptr, nullptr);
         sentinel->next = sentinel;
         sentinel->prev = sentinel;
+        adopt(sentinel);
         *this = src;
     }
     ~bi_ring()
     {
         clear();
+        release_quarantine();
+        release_free_slots();
         delete sentinel;
     }
     bi_ring &operator=(const bi_ring &src)
@@ -189,12 +887,15 @@ public:
         if (length != other.length) {
             return false;
         }
+        if constexpr (fingerprinted) {
+            if (!content_stale && !other.content_stale && content_hash != other.content_hash) {
+                return false;
+            }
+        }
 
-        auto thisIt = cbegin();
-        auto otherIt = other.cbegin();
-
-        for (; thisIt != cend(); thisIt.next(), otherIt.next()) {
-            if (thisIt.key() != otherIt.key() || thisIt.info() != otherIt.info()) {
+        for (Node *thisNode = sentinel->next, *otherNode = other.sentinel->next; thisNode != sentinel;
+             thisNode = thisNode->next, otherNode = otherNode->next) {
+            if (thisNode->key != otherNode->key || thisNode->info != otherNode->info) {
                 return false;
             }
         }
@@ -203,7 +904,65 @@ public:
     }
 
     bool operator!=(const bi_ring& other) const {
-        return this != other;
+        return !(*this == other);
+    }
+
+    /**
+     * @brief polynomial hash of all keys and infos by position, equal rings have equal
+     * fingerprints and any reordering changes it short of a hash collision.
+     *
+     * Inserts, erases, splices and assign() at either end of the ring keep it current
+     * in O(1). Changes in the middle, and key() or info() taken through a mod_iterator,
+     * make the next call rehash the ring once; read through const_iterator to avoid it.
+     * Available when Key and Info are hashable.
+     *
+     * The rehash is cached in the ring, so unlike other const members fingerprint() is
+     * not safe to call while other threads read the same ring, not even concurrently
+     * with another fingerprint(). Take it before sharing the ring or under a lock.
+     */
+    template <bool Enabled = fingerprinted, typename = enable_if_t<Enabled>>
+    [[nodiscard]] uint64_t fingerprint() const {
+        if (content_stale) {
+            uint64_t h = 0;
+            uint64_t power = 1;
+            for (Node *node = sentinel->prev; node != sentinel; node = node->prev) {
+                h = hash_add(hash_multiply(h, hash_base), element_hash(node));
+                power = hash_multiply(power, hash_base);
+            }
+            content_hash = h;
+            content_power = power;
+            content_stale = false;
+        }
+        return content_hash;
+    }
+
+    /**
+     * @brief makes the next fingerprint() rehash the ring
+     */
+    void invalidate_fingerprint() {
+        content_stale = true;
+    }
+
+    /**
+     * @brief replaces key and info of an element in place, keeping the fingerprint
+     * current when the element is at either end of the ring
+     *
+     * @param position iterator pointing on the element to overwrite
+     * @param key new key of the element
+     * @param info new info of the element
+     * @return mod_iterator pointing on the element
+     */
+    mod_iterator assign(const_iterator position, const Key &key, const Info &info) {
+        check_position(position);
+        Node *node = position.ptr;
+        if (node == sentinel) {
+            throw runtime_error("Cannot assign to the end of the ring");
+        }
+        hash_unlinking(node);
+        node->key = key;
+        node->info = info;
+        hash_linked(node);
+        return mod_iterator(node, this);
     }
 
     /**
@@ -217,13 +976,15 @@ public:
      */
     mod_iterator insert(const_iterator position, const Key &key, const Info &info)
     {
-        Node *newNode = new Node(key, info, nullptr, nullptr);
+        check_position(position);
+        Node *newNode = create_node(key, info);
 
         Node *positionNode = position.ptr;
         newNode->next = positionNode;
         newNode->prev = positionNode->prev;
         positionNode->prev->next = newNode;
         positionNode->prev = newNode;
+        hash_linked(newNode);
 
         length++;
 
@@ -238,6 +999,7 @@ public:
      */
     mod_iterator erase(const_iterator position)
     {
+        check_position(position);
         if (position == cend())
         {
             // If the iterator points to the end, nothing to erase
@@ -246,21 +1008,179 @@ public:
 
         Node *eraseNode = position.ptr;
         Node *nextNode = eraseNode->next;
+        hash_unlinking(eraseNode);
 
         eraseNode->prev->next = eraseNode->next;
         eraseNode->next->prev = eraseNode->prev;
 
-        delete eraseNode;
+        destroy_node(eraseNode);
 
         length--;
 
         return mod_iterator(nextNode, this);
     }
 
+    /**
+     * Moves an element of other ring before position without reallocating its node.
+     *
+     * @param position Iterator pointing on node before which the element is placed
+     * @param other ring the element belongs to, may be this ring
+     * @param element constant iterator pointing on element to be moved
+     * @return mod_iterator pointing on moved element
+     */
+    mod_iterator splice(const_iterator position, bi_ring &other, const_iterator element)
+    {
+        check_position(position);
+        other.check_position(element);
+        Node *node = element.ptr;
+        Node *positionNode = position.ptr;
+
+        if (node == other.sentinel)
+        {
+            return end();
+        }
+        if (&other == this && (node == positionNode || node->next == positionNode))
+        {
+            return mod_iterator(node, this);
+        }
+
+        other.hash_unlinking(node);
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+
+        node->next = positionNode;
+        node->prev = positionNode->prev;
+        positionNode->prev->next = node;
+        positionNode->prev = node;
+        adopt(node);
+        hash_linked(node);
+
+        other.length--;
+        length++;
+
+        return mod_iterator(node, this);
+    }
+
+    /**
+     * Moves an element of this ring before position without reallocating its node.
+     *
+     * @param position Iterator pointing on node before which the element is placed
+     * @param element constant iterator pointing on element to be moved
+     * @return mod_iterator pointing on moved element
+     */
+    mod_iterator splice(const_iterator position, const_iterator element)
+    {
+        return splice(position, *this, element);
+    }
+
+    /**
+     * Moves count consecutive elements of other ring, starting at first, before position
+     * with a single relink. Finding the end of the range walks count nodes.
+     *
+     * @param position Iterator pointing on node before which the elements are placed,
+     * must not be inside the moved range
+     * @param other ring the elements belong to, may be this ring
+     * @param first constant iterator pointing on first element to be moved
+     * @param count number of elements to move, trimmed to the end of other ring
+     * @return unsigned int number of moved elements
+     */
+    unsigned int splice(const_iterator position, bi_ring &other, const_iterator first, unsigned int count)
+    {
+        check_position(position);
+        other.check_position(first);
+        Node *firstNode = first.ptr;
+        Node *lastNode = firstNode->prev;
+        unsigned int moved = 0;
+        for (; moved < count && lastNode->next != other.sentinel; moved++)
+        {
+            lastNode = lastNode->next;
+            adopt(lastNode);
+        }
+        if (moved == 0)
+        {
+            return 0;
+        }
+
+        // hashing the moved range would walk it again, rehash lazily instead
+        content_stale = true;
+        other.content_stale = true;
+
+        firstNode->prev->next = lastNode->next;
+        lastNode->next->prev = firstNode->prev;
+
+        Node *positionNode = position.ptr;
+        firstNode->prev = positionNode->prev;
+        lastNode->next = positionNode;
+        positionNode->prev->next = firstNode;
+        positionNode->prev = lastNode;
+
+        other.length -= moved;
+        length += moved;
+        return moved;
+    }
+
+    /**
+     * Moves all elements of other ring before position in O(1), other ring is left empty.
+     *
+     * @param position Iterator pointing on node before which the elements are placed
+     * @param other ring to take the elements from, must not be this ring
+     */
+    void splice(const_iterator position, bi_ring &other)
+    {
+        check_position(position);
+        if (&other == this || other.isEmpty())
+        {
+            return;
+        }
+
+        Node *firstNode = other.sentinel->next;
+        Node *lastNode = other.sentinel->prev;
+        Node *positionNode = position.ptr;
+        if constexpr (fingerprinted)
+        {
+            // appending or prepending concatenates the polynomials, other splices rehash later
+            content_stale = content_stale || other.content_stale;
+            if (!content_stale && positionNode == sentinel)
+            {
+                content_hash = hash_add(content_hash, hash_multiply(other.content_hash, content_power));
+                content_power = hash_multiply(content_power, other.content_power);
+            }
+            else if (!content_stale && positionNode == sentinel->next)
+            {
+                content_hash = hash_add(other.content_hash, hash_multiply(content_hash, other.content_power));
+                content_power = hash_multiply(content_power, other.content_power);
+            }
+            else
+            {
+                content_stale = true;
+            }
+            other.reset_content_hash();
+        }
+        other.sentinel->next = other.sentinel;
+        other.sentinel->prev = other.sentinel;
+
+        firstNode->prev = positionNode->prev;
+        lastNode->next = positionNode;
+        positionNode->prev->next = firstNode;
+        positionNode->prev = lastNode;
+#if BI_RING_CHECKED_ITERATORS
+        for (Node *node = firstNode; node != positionNode; node = node->next)
+        {
+            adopt(node);
+        }
+#endif
+
+        length += other.length;
+        other.length = 0;
+    }
+
     void clear(){
+        // the hash is reset below, no need to keep it current while popping
+        content_stale = true;
         while(!isEmpty()){
             pop_back();
         }
+        reset_content_hash();
     }
 
     /**
@@ -296,16 +1216,267 @@ public:
     unsigned int occurrencesOf(const Key &key) const
     {
         unsigned int counter = 0;
-        for (auto it = cbegin(); it != cend(); it.next())
-        {
-            if (it.key() == key)
+        for_each([&](const Key &k, const Info &) {
+            if (k == key)
             {
                 counter++;
             }
-        }
+        });
         return counter;
     }
 
+    /**
+     * @brief occurrencesOf for a batch of keys in one pass over the ring
+     *
+     * Batches of up to linear_probe_limit keys are matched by comparing with each of
+     * them, bigger ones through a hash table when Key is hashable.
+     *
+     * @param keys keys to count, duplicates allowed
+     * @param count number of keys
+     * @return vector<unsigned int> number of occurrences of every key, in batch order
+     */
+    vector<unsigned int> count_keys(const Key *keys, size_t count) const
+    {
+        vector<size_t> slots;
+        size_t distinct = 0;
+        vector<unsigned int> found(count, 0);
+        probe_keys(keys, count, slots, distinct, [&](size_t slot, Node *) {
+            found[slot]++;
+            return true;
+        });
+
+        vector<unsigned int> result(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            result[i] = found[slots[i]];
+        }
+        return result;
+    }
+
+    vector<unsigned int> count_keys(const vector<Key> &keys) const
+    {
+        return count_keys(keys.data(), keys.size());
+    }
+
+#ifdef __cpp_lib_span
+    vector<unsigned int> count_keys(span<const Key> keys) const
+    {
+        return count_keys(keys.data(), keys.size());
+    }
+#endif
+
+    /**
+     * @brief first element of every key of a batch in one pass over the ring, the walk
+     * stops once all keys are found
+     *
+     * @param keys keys to find, duplicates allowed
+     * @param count number of keys
+     * @return vector<const_iterator> first element with each key, cend() if missing
+     */
+    vector<const_iterator> find_keys(const Key *keys, size_t count) const
+    {
+        vector<size_t> slots;
+        size_t distinct = 0;
+        size_t matched = 0;
+        vector<Node *> found(count, nullptr);
+        probe_keys(keys, count, slots, distinct, [&](size_t slot, Node *node) {
+            if (found[slot] == nullptr)
+            {
+                found[slot] = node;
+                return ++matched < distinct;
+            }
+            return true;
+        });
+
+        vector<const_iterator> result;
+        result.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            Node *node = found[slots[i]];
+            result.push_back(const_iterator(node == nullptr ? sentinel : node, this));
+        }
+        return result;
+    }
+
+    vector<const_iterator> find_keys(const vector<Key> &keys) const
+    {
+        return find_keys(keys.data(), keys.size());
+    }
+
+#ifdef __cpp_lib_span
+    vector<const_iterator> find_keys(span<const Key> keys) const
+    {
+        return find_keys(keys.data(), keys.size());
+    }
+#endif
+
+    /**
+     * @brief calls function on every element in ring order
+     *
+     * @param function callable taking (const Key &, const Info &)
+     */
+    template <typename Function>
+    void for_each(Function function) const
+    {
+        for (Node *node = sentinel->next; node != sentinel; node = node->next)
+        {
+            function(static_cast<const Key &>(node->key), static_cast<const Info &>(node->info));
+        }
+    }
+
+    /**
+     * @brief calls function on every element in ring order, info may be modified.
+     * Callables that also accept a const Info are treated as read only and leave the
+     * fingerprint current.
+     *
+     * @param function callable taking (const Key &, Info &)
+     */
+    template <typename Function>
+    void for_each(Function function)
+    {
+        if constexpr (is_invocable<Function &, const Key &, const Info &>::value)
+        {
+            as_const(*this).for_each(function);
+        }
+        else
+        {
+            content_stale = true;
+            for (Node *node = sentinel->next; node != sentinel; node = node->next)
+            {
+                function(static_cast<const Key &>(node->key), node->info);
+            }
+        }
+    }
+
+    /**
+     * @brief makes the ring allocate new nodes from pool, nullptr returns to the heap.
+     * Existing nodes stay where they are until compact().
+     */
+    void set_pool(node_pool *pool)
+    {
+        this->pool = pool;
+    }
+
+    [[nodiscard]] node_pool *get_pool() const
+    {
+        return pool;
+    }
+
+    /**
+     * @brief binds the storage of new nodes to a NUMA node through its shared pool
+     *
+     * @param numa_node node to place the nodes on, see bi_ring_numa_current_node()
+     */
+    void bind(int numa_node)
+    {
+        set_pool(&node_pool::for_node(numa_node));
+    }
+
+    /**
+     * @brief preallocates nodes so the ring can hold count elements without allocating
+     *
+     * The nodes are carved out of one contiguous block. Erased nodes are kept for reuse
+     * until the ring is destroyed or compacted. Rings with a pool take the nodes from it
+     * and hand erased ones back to the pool instead.
+     *
+     * @param count number of elements the ring has to hold
+     */
+    void reserve(unsigned int count)
+    {
+        if (count <= length + free_count)
+        {
+            return;
+        }
+
+        unsigned int missing = count - length - free_count;
+        if (pool != nullptr)
+        {
+            for (unsigned int i = 0; i < missing; i++)
+            {
+                free_slot *slot = pool->acquire();
+                slot->next = free_slots;
+                free_slots = slot;
+            }
+            free_count += missing;
+            return;
+        }
+
+        node_block *block = allocate_block(missing);
+        Node *slots = block->slots();
+        for (unsigned int i = missing; i > 0; i--)
+        {
+            free_slots = new (&slots[i - 1]) free_slot{free_slots, block};
+        }
+        free_count += missing;
+    }
+
+    /**
+     * @brief reallocates all nodes into one contiguous block in ring order
+     *
+     * After long runs of insert and erase ring order no longer matches memory order,
+     * compact restores it so traversals walk memory sequentially. Spare slots kept
+     * for reuse are released, in checked builds only by the destructor. Rings with a pool are moved into fresh slots of the pool,
+     * which are contiguous within a batch. All iterators are invalidated.
+     */
+    void compact()
+    {
+        if (isEmpty())
+        {
+            return;
+        }
+
+        // pool slots are taken up front, or erased nodes would be handed right back
+        free_slot *fresh = nullptr;
+        node_block *block = nullptr;
+        if (pool != nullptr)
+        {
+            free_slot **tail = &fresh;
+            for (unsigned int i = 0; i < length; i++)
+            {
+                *tail = pool->acquire();
+                tail = &(*tail)->next;
+            }
+            *tail = nullptr;
+        }
+        else
+        {
+            block = allocate_block(length);
+        }
+        unsigned int index = 0;
+        Node *last = sentinel;
+
+        for (Node *node = sentinel->next; node != sentinel; index++)
+        {
+            Node *next = node->next;
+            Node *slot;
+            node_block *slot_block = block;
+            if (fresh != nullptr)
+            {
+                slot_block = fresh->block;
+                slot = reinterpret_cast<Node *>(fresh);
+                fresh = fresh->next;
+            }
+            else
+            {
+                slot = &block->slots()[index];
+            }
+            Node *moved = new (slot) Node(std::move(node->key), std::move(node->info), nullptr, last);
+            moved->block = slot_block;
+            adopt(moved);
+            last->next = moved;
+            last = moved;
+            destroy_node(node);
+            node = next;
+        }
+        last->next = sentinel;
+        sentinel->prev = last;
+
+#if !BI_RING_CHECKED_ITERATORS
+        // checked builds keep the old slots, stale iterators into them must still throw
+        release_free_slots();
+#endif
+    }
+
     /**
      * @brief inserts element in the beginning of the ring
      *
@@ -411,17 +1582,17 @@ template <typename Key, typename Info>
 bi_ring<Key, Info> filter(const bi_ring<Key, Info> &source, bool (*pred)(const Key &)){
     bi_ring<Key, Info> result;
 
-    for (auto it = source.cbegin(); it != source.cend(); it.next()){
-        if (pred(it.key())){
-            result.push_back(it.key(), it.info());
+    source.for_each([&](const Key &key, const Info &info){
+        if (pred(key)){
+            result.push_back(key, info);
         }
-    }
+    });
 
     return result;
 }
 
 template <typename Key, typename Info>
-Info sum_info(const Key &, const Info &i1, const Info &i2){
+constexpr Info sum_info(const Key &, const Info &i1, const Info &i2){
     return i1 + i2;
 }
 
@@ -436,6 +1607,70 @@ bi_ring<Key, Info> join(const bi_ring<Key, Info> &first, const bi_ring<Key, Info
     return unique(pre_result, sum_info<Key, Info>);
 }
 
+/**
+ * @brief joins any number of rings in one pass, the equivalent of chained join() calls
+ *
+ * Every input is read once and keys are aggregated through a single hash table, the
+ * result is built from one bulk allocation. Keys keep the order of their first
+ * occurrence, infos are aggregated in input order. Key has to be hashable.
+ *
+ * @param rings pointers to the rings to join
+ * @param count number of rings
+ * @param aggregate function combining infos of the same key
+ * @return bi_ring<Key, Info> one element per distinct key
+ */
+template <typename Key, typename Info>
+bi_ring<Key, Info> join_all(const bi_ring<Key, Info> *const *rings, size_t count,
+                            Info (*aggregate)(const Key &, const Info &, const Info &) = sum_info<Key, Info>){
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++){
+        total += rings[i]->getLength();
+    }
+
+    unordered_map<Key, Info> totals;
+    vector<const pair<const Key, Info> *> order;
+    totals.reserve(total);
+
+    for (size_t i = 0; i < count; i++){
+        rings[i]->for_each([&](const Key &key, const Info &info){
+            auto found = totals.find(key);
+            if (found == totals.end()){
+                order.push_back(&*totals.emplace(key, info).first);
+            }
+            else {
+                found->second = aggregate(key, found->second, info);
+            }
+        });
+    }
+
+    bi_ring<Key, Info> result;
+    result.reserve(order.size());
+    for (const auto *entry : order){
+        result.push_back(entry->first, entry->second);
+    }
+    return result;
+}
+
+template <typename Key, typename Info>
+bi_ring<Key, Info> join_all(const vector<const bi_ring<Key, Info> *> &rings,
+                            Info (*aggregate)(const Key &, const Info &, const Info &) = sum_info<Key, Info>){
+    return join_all(rings.data(), rings.size(), aggregate);
+}
+
+#ifdef __cpp_lib_span
+template <typename Key, typename Info, size_t Extent>
+bi_ring<Key, Info> join_all(span<const bi_ring<Key, Info> *, Extent> rings,
+                            Info (*aggregate)(const Key &, const Info &, const Info &) = sum_info<Key, Info>){
+    return join_all(rings.data(), rings.size(), aggregate);
+}
+
+template <typename Key, typename Info, size_t Extent>
+bi_ring<Key, Info> join_all(span<const bi_ring<Key, Info> *const, Extent> rings,
+                            Info (*aggregate)(const Key &, const Info &, const Info &) = sum_info<Key, Info>){
+    return join_all(rings.data(), rings.size(), aggregate);
+}
+#endif
+
 template <typename Key, typename Info>
 bi_ring<Key, Info> unique(const bi_ring<Key, Info> &src, Info (*aggregate)(const Key &, const Info &, const Info &)) {
     bi_ring<Key, Info> result;
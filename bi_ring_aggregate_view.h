@@ -0,0 +1,278 @@
+#ifndef LAB2_BI_RING_AGGREGATE_VIEW_H
+#define LAB2_BI_RING_AGGREGATE_VIEW_H
+#include "bi_ring.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <unordered_map>
+
+/**
+ * Per-key aggregate of a ring kept up to date on every insert and erase, so reading
+ * the equivalent of unique(ring, aggregate) costs O(distinct keys) instead of O(n^2).
+ *
+ * Every element gets an order label, increasing along the ring, and each key keeps its
+ * elements in ring order. Erasing an element folds its info out of the key total with
+ * the inverse function. Without an inverse, and when an element is inserted anywhere but
+ * after the last one of its key, the key is recomputed from its own elements only. Keys
+ * in the result are ordered by their first element, like in unique().
+ *
+ * While the view is attached the ring must only be modified through it, and not be
+ * compacted since elements are tracked by address.
+ */
+template <typename Key, typename Info>
+class bi_ring_aggregate_view {
+public:
+    typedef Info (*aggregate_function)(const Key &, const Info &, const Info &);
+    typedef typename bi_ring<Key, Info>::mod_iterator mod_iterator;
+    typedef typename bi_ring<Key, Info>::const_iterator const_iterator;
+
+private:
+    typedef unsigned long long label_type;
+    // elements of one key in ring order, label to the info of the element
+    typedef bi_ring<label_type, const Info *> occurrence_ring;
+
+    // gap left between labels of appended elements
+    static constexpr label_type label_step = label_type(1) << 32;
+
+    struct group {
+        mod_iterator total;
+        occurrence_ring occurrences;
+
+        explicit group(mod_iterator total) : total(total) {}
+    };
+
+    bi_ring<Key, Info> &elements;
+    bi_ring<Key, Info> totals;
+    unordered_map<Key, group> groups;
+    // element info address to its entry in the occurrences of its key
+    unordered_map<const Info *, typename occurrence_ring::mod_iterator> positions;
+    // label of the first element of every key to its total, in unique() order
+    map<label_type, mod_iterator> firsts;
+    aggregate_function aggregate;
+    aggregate_function inverse;
+
+    label_type label_of(const_iterator position) const{
+        return positions.find(&position.info())->second.key();
+    }
+
+    // spreads labels evenly again once two neighbours have no free label between them
+    void relabel(){
+        label_type spacing = min(label_step, numeric_limits<label_type>::max() / (elements.getLength() + 2));
+        label_type label = 0;
+        for (auto it = elements.cbegin(); it != elements.cend(); it.next()){
+            label += spacing;
+            positions.find(&it.info())->second.key() = label;
+        }
+
+        firsts.clear();
+        for (auto &entry : groups){
+            firsts.emplace(entry.second.occurrences.cbegin().key(), entry.second.total);
+        }
+    }
+
+    // label for an element about to be inserted before position
+    label_type new_label(const_iterator position){
+        auto bounds = [&](label_type &before, label_type &after){
+            const_iterator previous = position;
+            before = position == elements.cbegin() ? 0 : label_of(previous.prev());
+            after = position == elements.cend() ? numeric_limits<label_type>::max() : label_of(position);
+        };
+
+        label_type before, after;
+        bounds(before, after);
+        if (after - before < 2){
+            relabel();
+            bounds(before, after);
+        }
+
+        label_type gap = after - before;
+        if (position == elements.cend()){
+            return before + min(label_step, gap / 2);
+        }
+        if (position == elements.cbegin()){
+            return after - min(label_step, gap / 2);
+        }
+        return before + gap / 2;
+    }
+
+    void recompute(group &key_group, const Key &key){
+        auto it = key_group.occurrences.cbegin();
+        Info total = *it.info();
+        for (it.next(); it != key_group.occurrences.cend(); it.next()){
+            total = aggregate(key, total, *it.info());
+        }
+        totals.assign(key_group.total, key, total);
+    }
+
+    // moves the total of a key to match the new first element of the key
+    void relink(group &key_group, const Key &key, label_type old_first){
+        label_type first = key_group.occurrences.cbegin().key();
+        firsts.erase(old_first);
+        auto next = firsts.upper_bound(first);
+
+        Info total = key_group.total.info();
+        totals.erase(key_group.total);
+        key_group.total = totals.insert(next == firsts.end() ? totals.cend() : next->second, key, total);
+        firsts.emplace(first, key_group.total);
+    }
+
+    void add(const_iterator element, label_type label){
+        const Key &key = element.key();
+        const Info &info = element.info();
+
+        auto found = groups.find(key);
+        if (found == groups.end()){
+            auto next = firsts.upper_bound(label);
+            mod_iterator total = totals.insert(next == firsts.end() ? totals.cend() : next->second, key, info);
+            group &key_group = groups.try_emplace(key, total).first->second;
+            positions.emplace(&info, key_group.occurrences.push_back(label, &info));
+            firsts.emplace(label, total);
+            return;
+        }
+
+        group &key_group = found->second;
+        auto spot = key_group.occurrences.cend();
+        while (spot != key_group.occurrences.cbegin()){
+            auto previous = spot;
+            if (previous.prev().key() < label){
+                break;
+            }
+            spot = previous;
+        }
+        label_type old_first = key_group.occurrences.cbegin().key();
+        bool last = spot == key_group.occurrences.cend();
+        auto occurrence = key_group.occurrences.insert(spot, label, &info);
+        positions.emplace(&info, occurrence);
+
+        if (last || inverse != nullptr){
+            totals.assign(key_group.total, key, aggregate(key, key_group.total.info(), info));
+        }
+        else {
+            recompute(key_group, key);
+        }
+        if (label < old_first){
+            relink(key_group, key, old_first);
+        }
+    }
+
+public:
+    /**
+     * Attaches to the ring and aggregates its current content in one pass.
+     *
+     * @param ring ring to aggregate, has to outlive the view
+     * @param aggregate function combining infos of the same key
+     * @param inverse function removing an info from a key total, nullptr if there is none
+     */
+    bi_ring_aggregate_view(bi_ring<Key, Info> &ring, aggregate_function aggregate, aggregate_function inverse = nullptr)
+        : elements(ring), aggregate(aggregate), inverse(inverse)
+    {
+        label_type label = 0;
+        for (auto it = elements.cbegin(); it != elements.cend(); it.next()){
+            label += label_step;
+            add(it, label);
+        }
+    }
+
+    bi_ring_aggregate_view(const bi_ring_aggregate_view &) = delete;
+    bi_ring_aggregate_view &operator=(const bi_ring_aggregate_view &) = delete;
+
+    /**
+     * Inserts a new element before position and updates the total of its key.
+     *
+     * @param position Iterator pointing on node before which the new node has to be inserted
+     * @param key The key of the new element to insert.
+     * @param info The info of the new element to insert.
+     * @return iterator pointing on inserted node
+     */
+    mod_iterator insert(const_iterator position, const Key &key, const Info &info){
+        label_type label = new_label(position);
+        mod_iterator inserted = elements.insert(position, key, info);
+        add(inserted, label);
+        return inserted;
+    }
+
+    /**
+     * Removes the specified element and updates the total of its key.
+     *
+     * @param position constant iterator pointing on element to be erased.
+     * @return mod_iterator pointing on next element after deleted
+     */
+    mod_iterator erase(const_iterator position){
+        if (position == elements.cend()){
+            return elements.end();
+        }
+
+        const Key &key = position.key();
+        auto found = groups.find(key);
+        group &key_group = found->second;
+
+        auto tracked = positions.find(&position.info());
+        auto occurrence = tracked->second;
+        positions.erase(tracked);
+        label_type label = occurrence.key();
+        bool first = occurrence == key_group.occurrences.begin();
+        key_group.occurrences.erase(occurrence);
+
+        if (key_group.occurrences.isEmpty()){
+            firsts.erase(label);
+            totals.erase(key_group.total);
+            groups.erase(found);
+            return elements.erase(position);
+        }
+
+        if (inverse != nullptr){
+            totals.assign(key_group.total, key, inverse(key, key_group.total.info(), position.info()));
+        }
+        else {
+            recompute(key_group, key);
+        }
+        if (first){
+            relink(key_group, key, label);
+        }
+        return elements.erase(position);
+    }
+
+    mod_iterator push_back(const Key &key, const Info &info){
+        return insert(elements.cend(), key, info);
+    }
+
+    mod_iterator push_front(const Key &key, const Info &info){
+        return insert(elements.cbegin(), key, info);
+    }
+
+    mod_iterator pop_front(){
+        return erase(elements.cbegin());
+    }
+
+    mod_iterator pop_back(){
+        if (elements.isEmpty()){
+            return elements.end();
+        }
+        return --erase(--elements.cend());
+    }
+
+    /**
+     * @brief current total of a key
+     *
+     * @param key key to look for
+     * @param [out] info total of the key if present
+     * @return true if the key is present in the ring
+     */
+    bool total(const Key &key, Info &info) const{
+        auto found = groups.find(key);
+        if (found == groups.end()){
+            return false;
+        }
+        info = found->second.total.info();
+        return true;
+    }
+
+    /**
+     * @brief one element per distinct key holding its total, the equivalent of unique()
+     */
+    const bi_ring<Key, Info> &result() const{
+        return totals;
+    }
+};
+
+#endif
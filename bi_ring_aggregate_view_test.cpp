@@ -0,0 +1,156 @@
+#include "catch2/catch_test_macros.hpp"
+#include "bi_ring_aggregate_view.h"
+#include "bi_ring_window.h"
+#include <random>
+
+template <typename Key, typename Info>
+Info _concatenate_view(const Key &, const Info &i1, const Info &i2)
+{
+    return i1 + "-" + i2;
+}
+
+TEST_CASE("aggregate view with inverse")
+{
+    bi_ring<string, int> ring;
+    ring.push_back("uno", 1);
+    ring.push_back("due", 2);
+    ring.push_back("uno", 3);
+
+    bi_ring_aggregate_view<string, int> view(ring, sum_info<string, int>, subtract_info<string, int>);
+    CHECK(view.result() == unique(ring, sum_info<string, int>));
+
+    view.push_back("tre", 3);
+    view.push_front("due", 5);
+    view.insert(++ring.cbegin(), "uno", 10);
+    // keys are ordered by their first element, due moved to the front
+    CHECK(view.result() == unique(ring, sum_info<string, int>));
+
+    int total = 0;
+    CHECK(view.total("due", total));
+    CHECK(total == 7);
+    CHECK(view.total("uno", total));
+    CHECK(total == 14);
+    CHECK(!view.total("cinque", total));
+
+    view.pop_front();
+    view.erase(ring.cbegin());
+    CHECK(view.total("uno", total));
+    CHECK(total == 4);
+    CHECK(view.total("due", total));
+    CHECK(total == 2);
+
+    // last element of a key drops the key
+    view.pop_back();
+    CHECK(!view.total("tre", total));
+    CHECK(view.result().getLength() == 2);
+    CHECK(view.result() == unique(ring, sum_info<string, int>));
+}
+
+TEST_CASE("aggregate view without inverse")
+{
+    bi_ring<int, string> ring;
+    bi_ring_aggregate_view<int, string> view(ring, _concatenate_view);
+
+    view.push_back(1, "un");
+    view.push_back(2, "deux");
+    view.push_back(1, "one");
+    view.push_back(2, "two");
+    view.push_back(1, "один");
+    CHECK(view.result() == unique(ring, _concatenate_view));
+
+    // order sensitive aggregates are recomputed for the affected key only
+    view.insert(++ring.cbegin(), 1, "uno");
+    string total;
+    CHECK(view.total(1, total));
+    CHECK(total == "un-uno-one-один");
+
+    view.erase(++ring.cbegin());
+    CHECK(view.total(1, total));
+    CHECK(total == "un-one-один");
+    CHECK(view.result() == unique(ring, _concatenate_view));
+}
+
+TEST_CASE("aggregate view matches unique")
+{
+    bi_ring<int, int> ring;
+    bi_ring_aggregate_view<int, int> view(ring, sum_info<int, int>, subtract_info<int, int>);
+
+    mt19937 gen(3);
+    uniform_int_distribution<int> keys(0, 20);
+    for (int i = 0; i < 300; i++)
+    {
+        view.push_back(keys(gen), i);
+        if (i % 3 == 2)
+        {
+            view.erase(ring.cbegin() + keys(gen));
+        }
+    }
+
+    auto expected = unique(ring, sum_info<int, int>);
+    CHECK(view.result().getLength() == expected.getLength());
+    for (auto it = expected.cbegin(); it != expected.cend(); it.next())
+    {
+        int total = 0;
+        REQUIRE(view.total(it.key(), total));
+        CHECK(total == it.info());
+    }
+}
+
+TEST_CASE("aggregate view keeps unique order")
+{
+    mt19937 gen(11);
+    uniform_int_distribution<int> keys(0, 9);
+    uniform_int_distribution<int> operations(0, 5);
+
+    for (bool with_inverse : {true, false})
+    {
+        bi_ring<int, int> ring;
+        bi_ring_aggregate_view<int, int> view(ring, sum_info<int, int>, with_inverse ? subtract_info<int, int> : nullptr);
+
+        for (int i = 0; i < 2000; i++)
+        {
+            int length = ring.getLength();
+            uniform_int_distribution<int> positions(0, max(length - 1, 0));
+            switch (operations(gen))
+            {
+            case 0:
+                view.push_front(keys(gen), i);
+                break;
+            case 1:
+                view.insert(length == 0 ? ring.cend() : ring.cbegin() + positions(gen), keys(gen), i);
+                break;
+            case 2:
+                view.pop_front();
+                break;
+            case 3:
+                view.pop_back();
+                break;
+            case 4:
+                if (length > 0)
+                {
+                    view.erase(ring.cbegin() + positions(gen));
+                }
+                break;
+            default:
+                view.push_back(keys(gen), i);
+                break;
+            }
+            REQUIRE(view.result() == unique(ring, sum_info<int, int>));
+        }
+    }
+}
+
+TEST_CASE("aggregate view relabels crowded inserts")
+{
+    bi_ring<int, string> ring;
+    bi_ring_aggregate_view<int, string> view(ring, _concatenate_view);
+    view.push_back(1, "a");
+    view.push_back(2, "z");
+
+    // always inserting right after the first element halves the same label gap
+    for (int i = 0; i < 100; i++)
+    {
+        view.insert(++ring.cbegin(), i % 3, to_string(i));
+    }
+    CHECK(view.result() == unique(ring, _concatenate_view));
+}
@@ -0,0 +1,118 @@
+#include "catch2/catch_test_macros.hpp"
+#include "catch2/benchmark/catch_benchmark.hpp"
+#include "bi_ring_lru_cache.h"
+#include "bi_ring_round_robin.h"
+#include "bi_ring_work_stealing.h"
+#include <random>
+#include <vector>
+
+// Benchmarks are hidden, run them with: EADS-lab-2 "[benchmark]"
+
+// keys with a skewed popularity, small keys are requested far more often
+static vector<int> skewed_keys(unsigned int count, int range)
+{
+    mt19937 gen(42);
+    vector<int> keys;
+    keys.reserve(count);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        uniform_int_distribution<int> bound(1, range);
+        uniform_int_distribution<int> key(0, bound(gen) - 1);
+        keys.push_back(key(gen));
+    }
+    return keys;
+}
+
+template <typename Key>
+static double replay(bi_ring_lru_cache<Key, int> &cache, const vector<Key> &keys)
+{
+    int info = 0;
+    for (const Key &key : keys)
+    {
+        if (!cache.get(key, info))
+        {
+            cache.put(key, 1);
+        }
+    }
+    return double(cache.hits()) / double(cache.hits() + cache.misses());
+}
+
+TEST_CASE("lru cache benchmark", "[.][benchmark]")
+{
+    const vector<int> keys = skewed_keys(100000, 10000);
+
+    for (auto policy : {eviction_policy::lru, eviction_policy::lfu})
+    {
+        const char *name = policy == eviction_policy::lru ? "lru" : "lfu";
+        bi_ring_lru_cache<int, int> cache(1000, policy);
+        cout << name << " hit rate: " << replay(cache, keys) << endl;
+
+        BENCHMARK(string(name) + " get/put 100000 requests")
+        {
+            bi_ring_lru_cache<int, int> timed(1000, policy);
+            return replay(timed, keys);
+        };
+    }
+}
+
+static long parallel_fib(bi_ring_scheduler &scheduler, int n)
+{
+    if (n < 16)
+    {
+        return n < 2 ? n : parallel_fib(scheduler, n - 1) + parallel_fib(scheduler, n - 2);
+    }
+    long left = 0;
+    bi_ring_scheduler::task_group group;
+    scheduler.spawn(group, [&] { left = parallel_fib(scheduler, n - 1); });
+    long right = parallel_fib(scheduler, n - 2);
+    scheduler.wait(group);
+    return left + right;
+}
+
+TEST_CASE("work stealing benchmark", "[.][benchmark]")
+{
+    for (unsigned int threads = 1; threads <= thread::hardware_concurrency() * 2; threads *= 2)
+    {
+        bi_ring_scheduler scheduler(threads);
+        BENCHMARK("fork join fib(30) on " + to_string(threads) + " threads")
+        {
+            bi_ring_scheduler::task_group root;
+            long result = 0;
+            scheduler.spawn(root, [&] { result = parallel_fib(scheduler, 30); });
+            scheduler.wait(root);
+            return result;
+        };
+    }
+}
+
+TEST_CASE("round robin benchmark", "[.][benchmark]")
+{
+    bi_ring<int, int> first;
+    bi_ring<int, int> second;
+    for (int i = 0; i < 1000; i++)
+    {
+        first.push_back(i, i);
+        second.push_back(-i, i);
+    }
+    const unsigned int reps = 20000;
+
+    BENCHMARK("shuffle 3:5 x 20000 then traverse")
+    {
+        long sum = 0;
+        shuffle(first, 3, second, 5, reps).for_each([&](const int &, const int &info) { sum += info; });
+        return sum;
+    };
+
+    BENCHMARK("round robin 3:5 x 20000")
+    {
+        bi_ring_round_robin<int, int> dispatcher;
+        dispatcher.add_source(first, 3);
+        dispatcher.add_source(second, 5);
+        long sum = 0;
+        for (unsigned int i = 0; i < reps * 8; i++)
+        {
+            sum += dispatcher.next().info();
+        }
+        return sum;
+    };
+}
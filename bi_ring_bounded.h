@@ -0,0 +1,119 @@
+#ifndef LAB2_BI_RING_BOUNDED_H
+#define LAB2_BI_RING_BOUNDED_H
+#include "bi_ring.h"
+
+/**
+ * Ring with a fixed capacity working as a circular buffer. All nodes are allocated
+ * up front, pushing into a full ring overwrites the element on the opposite end in
+ * place, so nothing is allocated or freed after construction.
+ */
+template <typename Key, typename Info>
+class bi_ring_bounded {
+private:
+    bi_ring<Key, Info> elements;
+    unsigned int max_length;
+
+public:
+    typedef typename bi_ring<Key, Info>::mod_iterator mod_iterator;
+    typedef typename bi_ring<Key, Info>::const_iterator const_iterator;
+
+    explicit bi_ring_bounded(unsigned int capacity) : max_length(capacity)
+    {
+        elements.reserve(capacity);
+    }
+
+    [[nodiscard]] unsigned int capacity() const{
+        return max_length;
+    }
+
+    [[nodiscard]] bool full() const{
+        return elements.getLength() == max_length;
+    }
+
+    [[nodiscard]] unsigned int getLength() const{
+        return elements.getLength();
+    }
+
+    [[nodiscard]] bool isEmpty() const{
+        return elements.isEmpty();
+    }
+
+    /**
+     * @brief inserts element in the end of the ring, overwriting the first one when full
+     *
+     * @param key is the key that will be inserted
+     * @param info is info that will be inserted
+     * @return iterator pointing on inserted element
+     */
+    mod_iterator push_back(const Key &key, const Info &info)
+    {
+        if (max_length == 0)
+        {
+            return elements.end();
+        }
+        if (!full())
+        {
+            return elements.push_back(key, info);
+        }
+
+        mod_iterator oldest = elements.assign(elements.cbegin(), key, info);
+        return elements.splice(elements.cend(), oldest);
+    }
+
+    /**
+     * @brief inserts element in the beginning of the ring, overwriting the last one when full
+     *
+     * @param key is the key that will be inserted
+     * @param info is info that will be inserted
+     * @return iterator pointing on inserted element
+     */
+    mod_iterator push_front(const Key &key, const Info &info)
+    {
+        if (max_length == 0)
+        {
+            return elements.end();
+        }
+        if (!full())
+        {
+            return elements.push_front(key, info);
+        }
+
+        mod_iterator newest = elements.assign(--elements.cend(), key, info);
+        return elements.splice(elements.cbegin(), newest);
+    }
+
+    mod_iterator pop_front()
+    {
+        return elements.pop_front();
+    }
+
+    mod_iterator pop_back()
+    {
+        return elements.pop_back();
+    }
+
+    void clear()
+    {
+        elements.clear();
+    }
+
+    const_iterator cbegin() const
+    {
+        return elements.cbegin();
+    }
+
+    const_iterator cend() const
+    {
+        return elements.cend();
+    }
+
+    /**
+     * @brief read access to the underlying ring, for filter, unique and the like
+     */
+    const bi_ring<Key, Info> &ring() const
+    {
+        return elements;
+    }
+};
+
+#endif
@@ -0,0 +1,71 @@
+#include "catch2/catch_test_macros.hpp"
+#include "bi_ring_bounded.h"
+
+TEST_CASE("bounded push back overwrites oldest")
+{
+    bi_ring_bounded<int, string> window(3);
+    CHECK(window.capacity() == 3);
+    CHECK(window.isEmpty());
+    CHECK(!window.full());
+
+    window.push_back(1, "one");
+    window.push_back(2, "two");
+    window.push_back(3, "three");
+    CHECK(window.full());
+
+    const int *storage = &window.cbegin().key();
+    auto it = window.push_back(4, "four");
+    CHECK(it.key() == 4);
+    CHECK(window.getLength() == 3);
+    // the node of the oldest element was reused
+    CHECK(&it.key() == storage);
+
+    window.push_back(5, "five");
+    int expected[] = {3, 4, 5};
+    int i = 0;
+    for (auto el = window.cbegin(); el != window.cend(); el.next())
+    {
+        CHECK(el.key() == expected[i++]);
+    }
+    CHECK(i == 3);
+
+    // overwrites keep the fingerprint of the ring current
+    bi_ring<int, string> same;
+    same.push_back(3, "three");
+    same.push_back(4, "four");
+    same.push_back(5, "five");
+    CHECK(window.ring().fingerprint() == same.fingerprint());
+    CHECK(window.ring() == same);
+
+    // wrap-around iterators walk the buffer as a circle
+    auto circle = window.cbegin();
+    for (int step = 0; step < 3; step++)
+    {
+        circle++;
+    }
+    CHECK(circle.key() == 3);
+}
+
+TEST_CASE("bounded push front overwrites newest")
+{
+    bi_ring_bounded<int, string> window(2);
+    window.push_front(1, "one");
+    window.push_front(2, "two");
+    window.push_front(3, "three");
+    CHECK(window.getLength() == 2);
+    CHECK(window.cbegin().key() == 3);
+    CHECK((--window.cend()).key() == 2);
+
+    window.pop_back();
+    CHECK(!window.full());
+    window.push_back(4, "four");
+    CHECK(window.ring().occurrencesOf(4) == 1);
+    CHECK(window.full());
+
+    window.clear();
+    CHECK(window.isEmpty());
+
+    bi_ring_bounded<int, string> none(0);
+    none.push_back(1, "one");
+    CHECK(none.isEmpty());
+}
@@ -0,0 +1,236 @@
+#ifndef LAB2_BI_RING_CHANNEL_H
+#define LAB2_BI_RING_CHANNEL_H
+#include "bi_ring.h"
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define BI_RING_COROUTINES 1
+#endif
+
+/**
+ * Producer/consumer queue of ring elements. Consumers block in pop or drain until
+ * elements arrive instead of polling isEmpty. Batches are moved in and out by
+ * splicing nodes, so they are never copied.
+ *
+ * In C++20 builds pop_async returns an awaitable suspending the calling coroutine.
+ * A suspended coroutine is resumed on the thread that pushes its element or closes
+ * the channel.
+ */
+template <typename Key, typename Info>
+class bi_ring_channel {
+private:
+    bi_ring<Key, Info> queue;
+    mutable mutex lock;
+    condition_variable ready;
+    bool closed;
+
+#ifdef BI_RING_COROUTINES
+public:
+    class pop_awaiter {
+    private:
+        friend class bi_ring_channel;
+
+        bi_ring_channel &channel;
+        optional<pair<Key, Info>> item;
+        coroutine_handle<> handle;
+        pop_awaiter *next;
+
+        explicit pop_awaiter(bi_ring_channel &channel): channel(channel), next(nullptr) {}
+
+    public:
+        bool await_ready(){
+            lock_guard<mutex> guard(channel.lock);
+            return channel.take(item) || channel.closed;
+        }
+
+        bool await_suspend(coroutine_handle<> waiting){
+            lock_guard<mutex> guard(channel.lock);
+            if (channel.take(item) || channel.closed){
+                return false;
+            }
+            handle = waiting;
+            if (channel.last_waiter == nullptr){
+                channel.first_waiter = this;
+            }
+            else {
+                channel.last_waiter->next = this;
+            }
+            channel.last_waiter = this;
+            return true;
+        }
+
+        // empty once the channel is closed and drained
+        optional<pair<Key, Info>> await_resume(){
+            return std::move(item);
+        }
+    };
+
+private:
+    pop_awaiter *first_waiter = nullptr;
+    pop_awaiter *last_waiter = nullptr;
+
+    // hands queued elements to suspended coroutines, returns the chain to resume
+    pop_awaiter *serve_waiters(){
+        pop_awaiter *served = nullptr;
+        pop_awaiter **tail = &served;
+        while (first_waiter != nullptr && (closed || !queue.isEmpty())){
+            pop_awaiter *waiter = first_waiter;
+            first_waiter = waiter->next;
+            take(waiter->item);
+            waiter->next = nullptr;
+            *tail = waiter;
+            tail = &waiter->next;
+        }
+        if (first_waiter == nullptr){
+            last_waiter = nullptr;
+        }
+        return served;
+    }
+
+    static void resume(pop_awaiter *served){
+        while (served != nullptr){
+            pop_awaiter *waiter = served;
+            served = served->next;
+            waiter->handle.resume();
+        }
+    }
+#endif
+
+    bool take(optional<pair<Key, Info>> &item){
+        if (queue.isEmpty()){
+            return false;
+        }
+        auto first = queue.begin();
+        item.emplace(std::move(first.key()), std::move(first.info()));
+        queue.pop_front();
+        return true;
+    }
+
+    // called with lock held, wakes consumers after elements arrived or the channel closed
+    template <typename Guard>
+    void notify(Guard &guard){
+#ifdef BI_RING_COROUTINES
+        pop_awaiter *served = serve_waiters();
+        guard.unlock();
+        resume(served);
+#else
+        guard.unlock();
+#endif
+        ready.notify_all();
+    }
+
+public:
+    bi_ring_channel() : closed(false) {}
+
+    bi_ring_channel(const bi_ring_channel &) = delete;
+    bi_ring_channel &operator=(const bi_ring_channel &) = delete;
+
+    /**
+     * @brief appends element to the channel, waking a waiting consumer
+     *
+     * @param key is the key that will be inserted
+     * @param info is info that will be inserted
+     */
+    void push_back(const Key &key, const Info &info){
+        unique_lock<mutex> guard(lock);
+        queue.push_back(key, info);
+        notify(guard);
+    }
+
+    /**
+     * @brief moves all elements of batch to the channel in one splice, batch is left empty
+     *
+     * @param batch elements to append
+     */
+    void push_back(bi_ring<Key, Info> &batch){
+        unique_lock<mutex> guard(lock);
+        queue.splice(queue.cend(), batch);
+        notify(guard);
+    }
+
+    /**
+     * @brief takes the first element, blocking until there is one
+     *
+     * @param [out] key key of taken element
+     * @param [out] info info of taken element
+     * @return false if the channel was closed and nothing is left
+     */
+    bool pop(Key &key, Info &info){
+        unique_lock<mutex> guard(lock);
+        ready.wait(guard, [this]{ return closed || !queue.isEmpty(); });
+        if (queue.isEmpty()){
+            return false;
+        }
+        auto first = queue.begin();
+        key = std::move(first.key());
+        info = std::move(first.info());
+        queue.pop_front();
+        return true;
+    }
+
+    /**
+     * @brief takes the first element if there is one, never blocks
+     *
+     * @return false if the channel is empty
+     */
+    bool try_pop(Key &key, Info &info){
+        lock_guard<mutex> guard(lock);
+        if (queue.isEmpty()){
+            return false;
+        }
+        auto first = queue.begin();
+        key = std::move(first.key());
+        info = std::move(first.info());
+        queue.pop_front();
+        return true;
+    }
+
+    /**
+     * @brief moves up to count elements to the end of out in one splice, blocking until
+     * there is at least one
+     *
+     * @param out ring receiving the elements
+     * @param count maximal number of elements to move
+     * @return unsigned int number of moved elements, 0 only if the channel was closed
+     */
+    unsigned int drain(bi_ring<Key, Info> &out, unsigned int count){
+        unique_lock<mutex> guard(lock);
+        ready.wait(guard, [this]{ return closed || !queue.isEmpty(); });
+        return out.splice(out.cend(), queue, queue.cbegin(), count);
+    }
+
+#ifdef BI_RING_COROUTINES
+    /**
+     * @brief awaitable taking the first element, suspends the coroutine until there is one
+     *
+     * @return pop_awaiter resuming with the element, or an empty optional once closed
+     */
+    pop_awaiter pop_async(){
+        return pop_awaiter(*this);
+    }
+#endif
+
+    /**
+     * @brief wakes all consumers, pop and drain fail once the remaining elements are taken
+     */
+    void close(){
+        unique_lock<mutex> guard(lock);
+        closed = true;
+        notify(guard);
+    }
+
+    [[nodiscard]] unsigned int getLength() const{
+        lock_guard<mutex> guard(lock);
+        return queue.getLength();
+    }
+
+    [[nodiscard]] bool isEmpty() const{
+        lock_guard<mutex> guard(lock);
+        return queue.isEmpty();
+    }
+};
+
+#endif
@@ -0,0 +1,139 @@
+#include "catch2/catch_test_macros.hpp"
+#include "bi_ring_channel.h"
+#include <thread>
+#include <vector>
+
+TEST_CASE("channel pop blocks until push")
+{
+    bi_ring_channel<int, string> channel;
+
+    int received = 0;
+    thread consumer([&] {
+        int key;
+        string info;
+        while (channel.pop(key, info))
+        {
+            CHECK(key == received);
+            received++;
+        }
+    });
+
+    for (int i = 0; i < 1000; i++)
+    {
+        channel.push_back(i, "A");
+    }
+    channel.close();
+    consumer.join();
+
+    CHECK(received == 1000);
+    CHECK(channel.isEmpty());
+}
+
+TEST_CASE("channel batches")
+{
+    bi_ring_channel<int, string> channel;
+
+    bi_ring<int, string> batch;
+    for (int i = 0; i < 10; i++)
+    {
+        batch.push_back(i, to_string(i));
+    }
+    channel.push_back(batch);
+    CHECK(batch.isEmpty());
+    CHECK(channel.getLength() == 10);
+
+    bi_ring<int, string> out;
+    CHECK(channel.drain(out, 4) == 4);
+    CHECK(out.getLength() == 4);
+    CHECK((--out.cend()).key() == 3);
+    CHECK(channel.drain(out, 100) == 6);
+    CHECK(out.getLength() == 10);
+
+    int key;
+    string info;
+    CHECK(!channel.try_pop(key, info));
+    channel.push_back(42, "answer");
+    CHECK(channel.try_pop(key, info));
+    CHECK(key == 42);
+    CHECK(info == "answer");
+
+    channel.close();
+    CHECK(channel.drain(out, 1) == 0);
+    CHECK(!channel.pop(key, info));
+}
+
+TEST_CASE("channel with many producers")
+{
+    bi_ring_channel<int, int> channel;
+    vector<thread> producers;
+    for (int p = 0; p < 4; p++)
+    {
+        producers.emplace_back([&channel, p] {
+            bi_ring<int, int> batch;
+            for (int i = 0; i < 250; i++)
+            {
+                batch.push_back(p, i);
+                if (batch.getLength() == 50)
+                {
+                    channel.push_back(batch);
+                }
+            }
+        });
+    }
+
+    long sum = 0;
+    unsigned int taken = 0;
+    bi_ring<int, int> out;
+    while (taken < 1000)
+    {
+        taken += channel.drain(out, 64);
+    }
+    out.for_each([&](const int &, const int &info) { sum += info; });
+    for (auto &producer : producers)
+    {
+        producer.join();
+    }
+    CHECK(out.getLength() == 1000);
+    CHECK(sum == 4 * (249 * 250 / 2));
+}
+
+#ifdef BI_RING_COROUTINES
+struct detached_task {
+    struct promise_type {
+        detached_task get_return_object() { return {}; }
+        suspend_never initial_suspend() { return {}; }
+        suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { terminate(); }
+    };
+};
+
+static detached_task consume(bi_ring_channel<int, string> &channel, vector<int> &keys, bool &finished)
+{
+    while (auto item = co_await channel.pop_async())
+    {
+        keys.push_back(item->first);
+    }
+    finished = true;
+}
+
+TEST_CASE("channel coroutine consumer")
+{
+    bi_ring_channel<int, string> channel;
+    channel.push_back(1, "one");
+
+    vector<int> keys;
+    bool finished = false;
+    consume(channel, keys, finished);
+    // the queued element was taken without suspending
+    CHECK(keys == vector<int>{1});
+
+    channel.push_back(2, "two");
+    channel.push_back(3, "three");
+    CHECK(keys == vector<int>{1, 2, 3});
+    CHECK(!finished);
+
+    channel.close();
+    CHECK(finished);
+}
+#endif
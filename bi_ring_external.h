@@ -0,0 +1,377 @@
+#ifndef LAB2_BI_RING_EXTERNAL_H
+#define LAB2_BI_RING_EXTERNAL_H
+#include "bi_ring.h"
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Binary format of keys and infos in spill and output files. Specialise it for other
+ * types: write and read one value, footprint estimates the memory a value holds.
+ */
+template <typename T, typename = void>
+struct bi_ring_serializer;
+
+template <typename T>
+struct bi_ring_serializer<T, enable_if_t<is_arithmetic<T>::value>> {
+    static void write(ostream &os, const T &value){
+        os.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    static bool read(istream &is, T &value){
+        return bool(is.read(reinterpret_cast<char *>(&value), sizeof(T)));
+    }
+
+    static size_t footprint(const T &){
+        return sizeof(T);
+    }
+};
+
+template <>
+struct bi_ring_serializer<string> {
+    static void write(ostream &os, const string &value){
+        uint64_t size = value.size();
+        os.write(reinterpret_cast<const char *>(&size), sizeof(size));
+        os.write(value.data(), streamsize(size));
+    }
+
+    static bool read(istream &is, string &value){
+        uint64_t size = 0;
+        if (!is.read(reinterpret_cast<char *>(&size), sizeof(size))){
+            return false;
+        }
+        value.resize(size);
+        return bool(is.read(&value[0], streamsize(size)));
+    }
+
+    static size_t footprint(const string &value){
+        return sizeof(string) + value.capacity();
+    }
+};
+
+/**
+ * Out-of-core unique: elements are buffered until the memory budget is used up, then
+ * sorted by key, aggregated and spilled to a run file. finish() merges the runs while
+ * applying the aggregate, at most max_fan_in at a time, and streams the result out
+ * sorted by key. Equal keys are aggregated in the order they were added.
+ *
+ * Key needs operator< and both types a bi_ring_serializer. Run files are removed by
+ * finish() and the destructor.
+ */
+template <typename Key, typename Info>
+class bi_ring_external_merger {
+public:
+    typedef Info (*aggregate_function)(const Key &, const Info &, const Info &);
+
+    // runs merged at once, bounds open files and read buffers
+    static constexpr unsigned int max_fan_in = 64;
+
+private:
+    typedef bi_ring_serializer<Key> key_serializer;
+    typedef bi_ring_serializer<Info> info_serializer;
+
+    struct run_reader {
+        ifstream file;
+        filesystem::path path;
+        Key key;
+        Info info;
+
+        // false at the end of the run, throws when a record is cut short
+        bool advance(){
+            if (file.peek() == ifstream::traits_type::eof()){
+                return false;
+            }
+            if (!key_serializer::read(file, key) || !info_serializer::read(file, info)){
+                throw runtime_error("Truncated spill file " + path.string());
+            }
+            return true;
+        }
+    };
+
+    aggregate_function aggregate;
+    size_t memory_budget;
+    filesystem::path directory;
+    string prefix;
+
+    vector<pair<Key, Info>> buffer;
+    size_t buffered;
+    vector<filesystem::path> runs;
+    unsigned int next_run;
+
+    filesystem::path new_run_path(){
+        return directory / (prefix + to_string(next_run++));
+    }
+
+    static void write_record(ofstream &out, const Key &key, const Info &info){
+        key_serializer::write(out, key);
+        info_serializer::write(out, info);
+    }
+
+    static ofstream open_output(const filesystem::path &path){
+        ofstream out(path, ios::binary | ios::trunc);
+        if (!out){
+            throw runtime_error("Cannot open spill file " + path.string());
+        }
+        return out;
+    }
+
+    // sorts and aggregates the buffer, equal keys keep their order thanks to stable_sort
+    template <typename Output>
+    void drain_buffer(Output &&output){
+        stable_sort(buffer.begin(), buffer.end(),
+                    [](const pair<Key, Info> &a, const pair<Key, Info> &b){ return a.first < b.first; });
+
+        for (size_t i = 0; i < buffer.size();){
+            const Key &key = buffer[i].first;
+            Info info = buffer[i].second;
+            size_t j = i + 1;
+            for (; j < buffer.size() && !(key < buffer[j].first); j++){
+                info = aggregate(key, info, buffer[j].second);
+            }
+            output(key, info);
+            i = j;
+        }
+        buffer.clear();
+        buffered = 0;
+    }
+
+    void spill(){
+        filesystem::path path = new_run_path();
+        ofstream out = open_output(path);
+        runs.push_back(path);
+        drain_buffer([&](const Key &key, const Info &info){ write_record(out, key, info); });
+        if (!out.flush()){
+            throw runtime_error("Cannot write spill file " + path.string());
+        }
+    }
+
+    // k-way merge of runs [first, last), the run index breaks ties so input order is kept
+    template <typename Output>
+    void merge_runs(size_t first, size_t last, Output &&output){
+        vector<run_reader> readers(last - first);
+        auto later = [&](size_t a, size_t b){
+            return readers[b].key < readers[a].key || (!(readers[a].key < readers[b].key) && b < a);
+        };
+        priority_queue<size_t, vector<size_t>, decltype(later)> heads(later);
+
+        for (size_t r = 0; r < readers.size(); r++){
+            readers[r].path = runs[first + r];
+            readers[r].file.open(runs[first + r], ios::binary);
+            if (!readers[r].file){
+                throw runtime_error("Cannot open spill file " + runs[first + r].string());
+            }
+            if (readers[r].advance()){
+                heads.push(r);
+            }
+        }
+
+        while (!heads.empty()){
+            size_t r = heads.top();
+            heads.pop();
+            Key key = std::move(readers[r].key);
+            Info info = std::move(readers[r].info);
+            if (readers[r].advance()){
+                heads.push(r);
+            }
+            while (!heads.empty() && !(key < readers[heads.top()].key)){
+                size_t same = heads.top();
+                heads.pop();
+                info = aggregate(key, info, readers[same].info);
+                if (readers[same].advance()){
+                    heads.push(same);
+                }
+            }
+            output(key, info);
+        }
+
+        for (size_t r = first; r < last; r++){
+            readers[r - first].file.close();
+            filesystem::remove(runs[r]);
+        }
+    }
+
+public:
+    /**
+     * @param aggregate function combining infos of the same key
+     * @param memory_budget bytes of elements buffered before a run is spilled
+     * @param directory where run files go, empty for the system temporary directory
+     */
+    bi_ring_external_merger(aggregate_function aggregate, size_t memory_budget, const string &directory = "")
+        : aggregate(aggregate), memory_budget(memory_budget),
+          directory(directory.empty() ? filesystem::temp_directory_path() : filesystem::path(directory)),
+          buffered(0), next_run(0)
+    {
+        random_device seed;
+        prefix = "bi_ring_run_" + to_string(seed()) + "_";
+    }
+
+    bi_ring_external_merger(const bi_ring_external_merger &) = delete;
+    bi_ring_external_merger &operator=(const bi_ring_external_merger &) = delete;
+
+    ~bi_ring_external_merger(){
+        error_code ignored;
+        for (const auto &run : runs){
+            filesystem::remove(run, ignored);
+        }
+    }
+
+    void add(const Key &key, const Info &info){
+        buffer.emplace_back(key, info);
+        buffered += sizeof(pair<Key, Info>) + key_serializer::footprint(key) + info_serializer::footprint(info);
+        if (buffered >= memory_budget){
+            spill();
+        }
+    }
+
+    void add(const bi_ring<Key, Info> &ring){
+        ring.for_each([&](const Key &key, const Info &info){ add(key, info); });
+    }
+
+    // run files written so far
+    [[nodiscard]] size_t spilled_runs() const{
+        return next_run;
+    }
+
+    /**
+     * @brief merges everything added so far and passes every distinct key with its
+     * aggregated info to output, sorted by key. The merger is empty afterwards.
+     */
+    template <typename Output>
+    void finish(Output &&output){
+        if (runs.empty()){
+            drain_buffer(output);
+            return;
+        }
+        if (!buffer.empty()){
+            spill();
+        }
+
+        // merge passes over consecutive groups, so equal keys still aggregate in input order
+        // merged runs are appended to runs right away, so the destructor removes them on errors
+        while (runs.size() > max_fan_in){
+            size_t count = runs.size();
+            for (size_t first = 0; first < count; first += max_fan_in){
+                size_t last = min<size_t>(first + max_fan_in, count);
+                if (last - first == 1){
+                    runs.push_back(runs[first]);
+                    continue;
+                }
+                filesystem::path path = new_run_path();
+                ofstream out = open_output(path);
+                runs.push_back(path);
+                merge_runs(first, last, [&](const Key &key, const Info &info){ write_record(out, key, info); });
+                if (!out.flush()){
+                    throw runtime_error("Cannot write spill file " + path.string());
+                }
+            }
+            runs.erase(runs.begin(), runs.begin() + count);
+        }
+        merge_runs(0, runs.size(), output);
+        runs.clear();
+    }
+};
+
+/**
+ * @brief unique() for rings whose working set does not fit in memory, see
+ * bi_ring_external_merger. Unlike unique() the result is sorted by key.
+ *
+ * @param src ring to remove duplicate keys from
+ * @param aggregate function combining infos of the same key
+ * @param memory_budget bytes of elements kept in memory before spilling to disk
+ * @param directory where run files go, empty for the system temporary directory
+ * @return bi_ring<Key, Info> one element per distinct key
+ */
+template <typename Key, typename Info>
+bi_ring<Key, Info> external_unique(const bi_ring<Key, Info> &src, Info (*aggregate)(const Key &, const Info &, const Info &),
+                                   size_t memory_budget, const string &directory = ""){
+    bi_ring_external_merger<Key, Info> merger(aggregate, memory_budget, directory);
+    merger.add(src);
+
+    bi_ring<Key, Info> result;
+    merger.finish([&](const Key &key, const Info &info){ result.push_back(key, info); });
+    return result;
+}
+
+/**
+ * @brief join() for rings whose working set does not fit in memory. Unlike join()
+ * the result is sorted by key.
+ *
+ * @param memory_budget bytes of elements kept in memory before spilling to disk
+ * @param aggregate function combining infos of the same key
+ * @param directory where run files go, empty for the system temporary directory
+ * @return bi_ring<Key, Info> one element per distinct key
+ */
+template <typename Key, typename Info>
+bi_ring<Key, Info> external_join(const bi_ring<Key, Info> &first, const bi_ring<Key, Info> &second, size_t memory_budget,
+                                 Info (*aggregate)(const Key &, const Info &, const Info &) = sum_info<Key, Info>,
+                                 const string &directory = ""){
+    bi_ring_external_merger<Key, Info> merger(aggregate, memory_budget, directory);
+    merger.add(first);
+    merger.add(second);
+
+    bi_ring<Key, Info> result;
+    merger.finish([&](const Key &key, const Info &info){ result.push_back(key, info); });
+    return result;
+}
+
+/**
+ * @brief external_join() streaming the result into a file instead of a ring,
+ * read it back with read_ring_file()
+ *
+ * @param path output file, overwritten
+ * @return size_t number of elements written
+ */
+template <typename Key, typename Info>
+size_t external_join_to_file(const bi_ring<Key, Info> &first, const bi_ring<Key, Info> &second, const string &path,
+                             size_t memory_budget, Info (*aggregate)(const Key &, const Info &, const Info &) = sum_info<Key, Info>,
+                             const string &directory = ""){
+    bi_ring_external_merger<Key, Info> merger(aggregate, memory_budget, directory);
+    merger.add(first);
+    merger.add(second);
+
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out){
+        throw runtime_error("Cannot open output file " + path);
+    }
+    size_t written = 0;
+    merger.finish([&](const Key &key, const Info &info){
+        bi_ring_serializer<Key>::write(out, key);
+        bi_ring_serializer<Info>::write(out, info);
+        written++;
+    });
+    if (!out.flush()){
+        throw runtime_error("Cannot write output file " + path);
+    }
+    return written;
+}
+
+/**
+ * @brief loads a file written by external_join_to_file()
+ */
+template <typename Key, typename Info>
+bi_ring<Key, Info> read_ring_file(const string &path){
+    ifstream in(path, ios::binary);
+    if (!in){
+        throw runtime_error("Cannot open input file " + path);
+    }
+
+    bi_ring<Key, Info> result;
+    Key key;
+    Info info;
+    while (bi_ring_serializer<Key>::read(in, key)){
+        if (!bi_ring_serializer<Info>::read(in, info)){
+            throw runtime_error("Truncated ring file " + path);
+        }
+        result.push_back(key, info);
+    }
+    return result;
+}
+
+#endif
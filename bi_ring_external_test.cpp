@@ -0,0 +1,123 @@
+#include "catch2/catch_test_macros.hpp"
+#include "bi_ring_external.h"
+#include <map>
+#include <random>
+
+static string concat(const int &, const string &s1, const string &s2)
+{
+    return s1 + s2;
+}
+
+TEST_CASE("external join")
+{
+    bi_ring<string, int> first;
+    first.push_back("uno", 1);
+    first.push_back("due", 2);
+    first.push_back("tre", 3);
+    first.push_back("uno", 4);
+
+    bi_ring<string, int> second;
+    second.push_back("due", 1);
+    second.push_back("cinque", 5);
+
+    // a budget of one element spills every element into its own run
+    for (size_t budget : {size_t(1), size_t(1) << 20})
+    {
+        auto result = external_join(first, second, budget);
+        bi_ring<string, int> expected;
+        expected.push_back("cinque", 5);
+        expected.push_back("due", 3);
+        expected.push_back("tre", 3);
+        expected.push_back("uno", 5);
+        CHECK(result == expected);
+    }
+
+    bi_ring<string, int> empty;
+    CHECK(external_join(empty, empty, 1).isEmpty());
+}
+
+TEST_CASE("external unique keeps aggregation order")
+{
+    bi_ring<int, string> src;
+    for (int i = 0; i < 300; i++)
+    {
+        src.push_back(i % 7, to_string(i % 10));
+    }
+
+    bi_ring_external_merger<int, string> merger(concat, 64);
+    merger.add(src);
+    CHECK(merger.spilled_runs() > bi_ring_external_merger<int, string>::max_fan_in);
+
+    map<int, string> expected;
+    for (int i = 0; i < 300; i++)
+    {
+        expected[i % 7] += to_string(i % 10);
+    }
+
+    bi_ring<int, string> result;
+    merger.finish([&](const int &key, const string &info) { result.push_back(key, info); });
+    REQUIRE(result.getLength() == 7);
+    auto it = result.cbegin();
+    for (const auto &element : expected)
+    {
+        CHECK(it.key() == element.first);
+        CHECK(it.info() == element.second);
+        it.next();
+    }
+
+    CHECK(external_unique(src, concat, 1000) == result);
+}
+
+TEST_CASE("external merge rejects truncated runs")
+{
+    filesystem::path directory = filesystem::temp_directory_path() / "bi_ring_external_truncated";
+    filesystem::remove_all(directory);
+    filesystem::create_directories(directory);
+
+    bi_ring<int, string> src;
+    for (int i = 0; i < 100; i++)
+    {
+        src.push_back(i % 7, "info" + to_string(i));
+    }
+    bi_ring_external_merger<int, string> merger(concat, 256, directory.string());
+    merger.add(src);
+    REQUIRE(merger.spilled_runs() > 1);
+
+    // cut the last record of a run in half, as a full disk would
+    filesystem::path run = filesystem::directory_iterator(directory)->path();
+    filesystem::resize_file(run, filesystem::file_size(run) - 3);
+
+    CHECK_THROWS(merger.finish([](const int &, const string &) {}));
+    filesystem::remove_all(directory);
+}
+
+TEST_CASE("external join to file")
+{
+    mt19937 gen(7);
+    uniform_int_distribution<long> keys(0, 500);
+    bi_ring<long, double> first;
+    bi_ring<long, double> second;
+    map<long, double> expected;
+    for (int i = 0; i < 5000; i++)
+    {
+        long key = keys(gen);
+        (i % 2 ? first : second).push_back(key, 0.5);
+        expected[key] += 0.5;
+    }
+
+    string path = (filesystem::temp_directory_path() / "bi_ring_external_test.bin").string();
+    CHECK(external_join_to_file(first, second, path, 4096) == expected.size());
+
+    auto result = read_ring_file<long, double>(path);
+    filesystem::remove(path);
+    REQUIRE(result.getLength() == expected.size());
+    auto it = result.cbegin();
+    for (const auto &element : expected)
+    {
+        CHECK(it.key() == element.first);
+        CHECK(it.info() == element.second);
+        it.next();
+    }
+
+    CHECK_THROWS(read_ring_file<long, double>(path));
+}
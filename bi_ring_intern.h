@@ -0,0 +1,145 @@
+#ifndef LAB2_BI_RING_INTERN_H
+#define LAB2_BI_RING_INTERN_H
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+/**
+ * String key stored once in a process wide table. Equal strings share one atom, so
+ * bi_ring<interned_string, Info> compares keys in find_key, occurrencesOf and unique
+ * by pointer, and duplicate keys do not hold their own heap copies.
+ *
+ * Atoms are never freed, intern a bounded set of keys only. Comparing with a plain
+ * string compares characters and does not add it to the table.
+ *
+ * Interning a string seen before allocates nothing: a small per-thread cache answers
+ * repeated keys without locking, the table is searched under a shared lock and only
+ * new strings take the exclusive lock.
+ */
+class interned_string {
+private:
+    const string *atom;
+
+    struct atom_table {
+        shared_mutex lock;
+        // deque keeps atoms in place, the index views their characters
+        deque<string> atoms;
+        unordered_map<string_view, const string *> index;
+    };
+
+    // slots of the per-thread cache of recently interned atoms
+    static const size_t cache_size = 64;
+
+    static const string *intern(string_view text){
+        static atom_table table;
+        static thread_local const string *cache[cache_size] = {};
+
+        const string *&cached = cache[hash<string_view>()(text) % cache_size];
+        if (cached != nullptr && *cached == text){
+            return cached;
+        }
+
+        {
+            shared_lock<shared_mutex> guard(table.lock);
+            auto found = table.index.find(text);
+            if (found != table.index.end()){
+                return cached = found->second;
+            }
+        }
+
+        lock_guard<shared_mutex> guard(table.lock);
+        auto found = table.index.find(text);
+        if (found == table.index.end()){
+            const string &atom = table.atoms.emplace_back(text);
+            found = table.index.emplace(atom, &atom).first;
+        }
+        return cached = found->second;
+    }
+
+    static const string *empty_atom(){
+        static const string *atom = intern("");
+        return atom;
+    }
+
+public:
+    interned_string() : atom(empty_atom()) {}
+    interned_string(const string &text) : atom(intern(text)) {}
+    interned_string(const char *text) : atom(intern(text)) {}
+    interned_string(string_view text) : atom(intern(text)) {}
+
+    const string &str() const{
+        return *atom;
+    }
+
+    // address of the shared atom, equal for equal strings
+    const string *id() const{
+        return atom;
+    }
+
+    operator const string &() const{
+        return *atom;
+    }
+
+    [[nodiscard]] size_t size() const{
+        return atom->size();
+    }
+
+    friend bool operator==(const interned_string &a, const interned_string &b){
+        return a.atom == b.atom;
+    }
+
+    friend bool operator!=(const interned_string &a, const interned_string &b){
+        return a.atom != b.atom;
+    }
+
+    friend bool operator==(const interned_string &a, const string &b){
+        return *a.atom == b;
+    }
+
+    friend bool operator==(const string &a, const interned_string &b){
+        return a == *b.atom;
+    }
+
+    friend bool operator==(const interned_string &a, const char *b){
+        return *a.atom == b;
+    }
+
+    friend bool operator==(const char *a, const interned_string &b){
+        return a == *b.atom;
+    }
+
+    friend bool operator!=(const interned_string &a, const string &b){
+        return !(a == b);
+    }
+
+    friend bool operator!=(const interned_string &a, const char *b){
+        return !(a == b);
+    }
+
+    // orders by content, so sorted output does not depend on interning order
+    friend bool operator<(const interned_string &a, const interned_string &b){
+        return a.atom != b.atom && *a.atom < *b.atom;
+    }
+
+    friend ostream &operator<<(ostream &os, const interned_string &s){
+        return os << *s.atom;
+    }
+};
+
+namespace std {
+    template <>
+    struct hash<interned_string> {
+        size_t operator()(const interned_string &s) const{
+            return hash<const string *>()(s.id());
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,107 @@
+#include "catch2/catch_test_macros.hpp"
+#include "bi_ring.h"
+#include "bi_ring_intern.h"
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+
+TEST_CASE("interned string")
+{
+    interned_string a = "uno";
+    interned_string b = string("uno");
+    interned_string c = "due";
+
+    CHECK(a == b);
+    CHECK(a.id() == b.id());
+    CHECK(a != c);
+    CHECK(a == "uno");
+    CHECK(a == string("uno"));
+    CHECK(a != "due");
+    CHECK(c < a);
+    CHECK(!(a < b));
+    CHECK(interned_string() == "");
+
+    const string &text = a;
+    CHECK(text == "uno");
+    CHECK(a.size() == 3);
+
+    stringstream out;
+    out << a;
+    CHECK(out.str() == "uno");
+
+    unordered_map<interned_string, int> counts;
+    counts[a]++;
+    counts[b]++;
+    CHECK(counts.size() == 1);
+    CHECK(counts[a] == 2);
+}
+
+TEST_CASE("interning from many threads")
+{
+    vector<vector<const string *>> ids(4);
+    vector<thread> workers;
+    for (int t = 0; t < 4; t++)
+    {
+        workers.emplace_back([&, t] {
+            // keys repeat, so most lookups hit the thread cache or the shared index
+            for (int i = 0; i < 2000; i++)
+            {
+                ids[t].push_back(interned_string("key" + to_string(i % 300)).id());
+            }
+        });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    for (int i = 0; i < 2000; i++)
+    {
+        CHECK(*ids[0][i] == "key" + to_string(i % 300));
+        for (int t = 1; t < 4; t++)
+        {
+            CHECK(ids[t][i] == ids[0][i]);
+        }
+    }
+    CHECK(interned_string("key7").id() == ids[2][7]);
+}
+
+bool long_interned(const interned_string &key)
+{
+    return key.size() > 3;
+}
+
+TEST_CASE("ring of interned keys")
+{
+    bi_ring<interned_string, int> first;
+    first.push_back("uno", 1);
+    first.push_back("due", 2);
+    first.push_back("tre", 3);
+    first.push_back("quattro", 4);
+
+    bi_ring<interned_string, int> second;
+    second.push_back("due", 1);
+    second.push_back("tre", 1);
+    second.push_back("quattro", 3);
+    second.push_back("cinque", 5);
+
+    // duplicate keys share storage
+    CHECK(&first.cbegin().get_next().key().str() == &second.cbegin().key().str());
+    CHECK(first.occurrencesOf("tre") == 1);
+
+    auto res = join(first, second);
+    string keys[] = {"uno", "due", "tre", "quattro", "cinque"};
+    int infos[] = {1, 3, 4, 7, 5};
+    auto it = res.cbegin();
+    for (int i = 0; i < 5; i++)
+    {
+        CHECK(it.key() == keys[i]);
+        CHECK(it.info() == infos[i]);
+        it.next();
+    }
+
+    auto filtered = filter(first, long_interned);
+    CHECK(filtered.getLength() == 1);
+    CHECK(filtered.cbegin().key() == "quattro");
+}
@@ -0,0 +1,221 @@
+#ifndef LAB2_BI_RING_LRU_CACHE_H
+#define LAB2_BI_RING_LRU_CACHE_H
+#include "bi_ring.h"
+#include <functional>
+#include <unordered_map>
+
+enum class eviction_policy {
+    lru, // evicts the least recently used entry
+    lfu  // evicts the least frequently used entry, ties broken by recency
+};
+
+/**
+ * Cache keeping its entries in a bi_ring ordered from the entry evicted last (front)
+ * to the next victim (back), with a hash index from key to ring position.
+ * Hits relink the node inside the ring, they never allocate.
+ */
+template <typename Key, typename Info>
+class bi_ring_lru_cache {
+private:
+    struct entry;
+
+    typedef bi_ring<Key, entry> order_ring;
+    typedef typename order_ring::mod_iterator position;
+    // lfu only: one header per use count present, from the highest count down,
+    // holding the front-most entry of the group
+    typedef bi_ring<unsigned int, position> group_ring;
+    typedef typename group_ring::mod_iterator group_position;
+
+    struct entry {
+        Info info;
+        // lfu only: header of the use count group of the entry
+        group_position group;
+    };
+
+    order_ring order;
+    unordered_map<Key, position> index;
+    // lfu only: entries of equal use count are adjacent in order, in the order of their headers
+    group_ring groups;
+
+    unsigned int max_size;
+    eviction_policy policy;
+    function<void(const Key &, const Info &)> on_evict;
+
+    unsigned long hit_count;
+    unsigned long miss_count;
+
+    // takes entry out of its use count group, keeping the group head valid
+    void leave_group(position pos){
+        group_position group = pos.info().group;
+        if (group.info() != pos){
+            return;
+        }
+        auto next = pos.get_next();
+        if (next != order.end() && next.info().group == group){
+            group.info() = next;
+        }
+        else {
+            groups.erase(group);
+        }
+    }
+
+    void touch(position pos){
+        if (policy == eviction_policy::lru){
+            order.splice(order.cbegin(), pos);
+            return;
+        }
+
+        group_position group = pos.info().group;
+        unsigned int uses = group.key();
+        group_position upper = group.get_prev();
+        if (upper != groups.end() && upper.key() == uses + 1){
+            leave_group(pos);
+            order.splice(upper.info(), pos);
+            upper.info() = pos;
+            pos.info().group = upper;
+            return;
+        }
+
+        auto next = pos.get_next();
+        if (group.info() == pos && (next == order.end() || next.info().group != group)){
+            // sole member, the group moves up a use count in place
+            group.key() = uses + 1;
+            return;
+        }
+
+        position head = group.info();
+        leave_group(pos);
+        if (head != pos){
+            order.splice(head, pos);
+        }
+        // takes a header erased earlier from the free slots of groups, no allocation
+        pos.info().group = groups.insert(group, uses + 1, pos);
+    }
+
+    void evict(){
+        position victim = --order.end();
+        if (policy == eviction_policy::lfu){
+            leave_group(victim);
+        }
+        if (on_evict){
+            on_evict(victim.key(), victim.info().info);
+        }
+        index.erase(victim.key());
+        order.erase(victim);
+    }
+
+public:
+    /**
+     * @param capacity maximal number of entries kept
+     * @param policy which entry gets evicted when the cache is full
+     * @param on_evict called with every evicted entry, before it is removed
+     */
+    explicit bi_ring_lru_cache(unsigned int capacity, eviction_policy policy = eviction_policy::lru,
+                               function<void(const Key &, const Info &)> on_evict = nullptr)
+        : max_size(capacity), policy(policy), on_evict(std::move(on_evict)), hit_count(0), miss_count(0)
+    {
+        index.reserve(capacity);
+        if (policy == eviction_policy::lfu){
+            groups.reserve(capacity);
+        }
+    }
+
+    bi_ring_lru_cache(const bi_ring_lru_cache &) = delete;
+    bi_ring_lru_cache &operator=(const bi_ring_lru_cache &) = delete;
+
+    /**
+     * @brief looks the key up and marks it as used
+     *
+     * @param key key to look for
+     * @param [out] info info of the entry if found
+     * @return true if the key is cached
+     */
+    bool get(const Key &key, Info &info){
+        auto found = index.find(key);
+        if (found == index.end()){
+            miss_count++;
+            return false;
+        }
+        hit_count++;
+        touch(found->second);
+        info = found->second.info().info;
+        return true;
+    }
+
+    /**
+     * @brief inserts or updates the entry, evicting one when the cache is full
+     *
+     * @param key key of the entry
+     * @param info info of the entry
+     */
+    void put(const Key &key, const Info &info){
+        auto found = index.find(key);
+        if (found != index.end()){
+            found->second.info().info = info;
+            touch(found->second);
+            return;
+        }
+        if (max_size == 0){
+            return;
+        }
+        if (order.getLength() == max_size){
+            evict();
+        }
+
+        if (policy == eviction_policy::lru){
+            index.emplace(key, order.push_front(key, entry{info, group_position()}));
+            return;
+        }
+        group_position lowest = --groups.end();
+        if (!groups.isEmpty() && lowest.key() == 1){
+            position pos = order.insert(lowest.info(), key, entry{info, lowest});
+            lowest.info() = pos;
+            index.emplace(key, pos);
+            return;
+        }
+        position pos = order.push_back(key, entry{info, group_position()});
+        pos.info().group = groups.push_back(1, pos);
+        index.emplace(key, pos);
+    }
+
+    /**
+     * @brief removes the entry without calling the eviction callback
+     *
+     * @param key key of the entry
+     * @return true if the entry was cached
+     */
+    bool erase(const Key &key){
+        auto found = index.find(key);
+        if (found == index.end()){
+            return false;
+        }
+        if (policy == eviction_policy::lfu){
+            leave_group(found->second);
+        }
+        order.erase(found->second);
+        index.erase(found);
+        return true;
+    }
+
+    [[nodiscard]] bool contains(const Key &key) const{
+        return index.count(key) != 0;
+    }
+
+    [[nodiscard]] unsigned int capacity() const{
+        return max_size;
+    }
+
+    [[nodiscard]] unsigned int size() const{
+        return order.getLength();
+    }
+
+    [[nodiscard]] unsigned long hits() const{
+        return hit_count;
+    }
+
+    [[nodiscard]] unsigned long misses() const{
+        return miss_count;
+    }
+};
+
+#endif
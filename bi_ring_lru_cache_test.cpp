@@ -0,0 +1,151 @@
+#include "catch2/catch_test_macros.hpp"
+#include "bi_ring_lru_cache.h"
+#include <algorithm>
+#include <map>
+#include <random>
+#include <vector>
+
+TEST_CASE("lru cache get put")
+{
+    bi_ring_lru_cache<string, int> cache(2);
+    CHECK(cache.capacity() == 2);
+    CHECK(cache.size() == 0);
+
+    int info = 0;
+    CHECK(!cache.get("uno", info));
+
+    cache.put("uno", 1);
+    cache.put("due", 2);
+    CHECK(cache.size() == 2);
+    CHECK(cache.get("uno", info));
+    CHECK(info == 1);
+
+    // "due" is the least recently used one now
+    cache.put("tre", 3);
+    CHECK(cache.size() == 2);
+    CHECK(!cache.contains("due"));
+    CHECK(cache.contains("uno"));
+    CHECK(cache.contains("tre"));
+
+    // updating an entry counts as a use
+    cache.put("uno", 11);
+    cache.put("quattro", 4);
+    CHECK(!cache.contains("tre"));
+    CHECK(cache.get("uno", info));
+    CHECK(info == 11);
+
+    CHECK(cache.hits() == 2);
+    CHECK(cache.misses() == 1);
+}
+
+TEST_CASE("lru cache erase and eviction callback")
+{
+    vector<pair<int, string>> evicted;
+    bi_ring_lru_cache<int, string> cache(3, eviction_policy::lru, [&](const int &key, const string &info) {
+        evicted.emplace_back(key, info);
+    });
+
+    for (int i = 1; i <= 5; i++)
+    {
+        cache.put(i, to_string(i));
+    }
+    REQUIRE(evicted.size() == 2);
+    CHECK(evicted[0] == make_pair(1, string("1")));
+    CHECK(evicted[1] == make_pair(2, string("2")));
+
+    CHECK(cache.erase(4));
+    CHECK(!cache.erase(4));
+    CHECK(cache.size() == 2);
+    CHECK(evicted.size() == 2);
+
+    bi_ring_lru_cache<int, string> none(0);
+    none.put(1, "one");
+    CHECK(none.size() == 0);
+}
+
+TEST_CASE("lfu cache")
+{
+    vector<int> evicted;
+    bi_ring_lru_cache<int, int> cache(3, eviction_policy::lfu, [&](const int &key, const int &) {
+        evicted.push_back(key);
+    });
+
+    int info = 0;
+    cache.put(1, 10);
+    cache.put(2, 20);
+    cache.put(3, 30);
+    cache.get(1, info);
+    cache.get(1, info);
+    cache.get(2, info);
+
+    // 3 was used once only
+    cache.put(4, 40);
+    REQUIRE(evicted.size() == 1);
+    CHECK(evicted[0] == 3);
+
+    // 4 was used once, 2 twice, 1 three times
+    cache.put(5, 50);
+    REQUIRE(evicted.size() == 2);
+    CHECK(evicted[1] == 4);
+
+    // ties are broken by recency
+    cache.get(5, info);
+    cache.put(6, 60);
+    REQUIRE(evicted.size() == 3);
+    CHECK(evicted[2] == 2);
+
+    CHECK(cache.erase(1));
+    CHECK(cache.size() == 2);
+    CHECK(cache.get(5, info));
+    CHECK(info == 50);
+    cache.put(7, 70);
+    cache.put(8, 80);
+    REQUIRE(evicted.size() == 4);
+    CHECK(evicted[3] == 6);
+}
+
+TEST_CASE("lfu cache matches a reference model")
+{
+    vector<int> evicted;
+    bi_ring_lru_cache<int, int> cache(8, eviction_policy::lfu, [&](const int &key, const int &) {
+        evicted.push_back(key);
+    });
+    // key to its use count and the time of its last use, the smallest pair is evicted
+    map<int, pair<unsigned int, int>> model;
+
+    mt19937 gen(5);
+    uniform_int_distribution<int> keys(0, 15);
+    for (int time = 0; time < 5000; time++)
+    {
+        int key = keys(gen);
+        auto found = model.find(key);
+        if (found != model.end())
+        {
+            found->second = {found->second.first + 1, time};
+        }
+
+        if (time % 4 == 0)
+        {
+            int info = 0;
+            CHECK(cache.get(key, info) == (found != model.end()));
+            continue;
+        }
+
+        cache.put(key, time);
+        if (found == model.end())
+        {
+            if (model.size() == 8)
+            {
+                auto victim = min_element(model.begin(), model.end(), [](const auto &a, const auto &b) {
+                    return a.second < b.second;
+                });
+                REQUIRE(evicted.size() == 1);
+                CHECK(evicted[0] == victim->first);
+                model.erase(victim);
+            }
+            model[key] = {1, time};
+        }
+        CHECK(cache.size() == model.size());
+        evicted.clear();
+    }
+}
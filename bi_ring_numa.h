@@ -0,0 +1,78 @@
+#ifndef LAB2_BI_RING_NUMA_H
+#define LAB2_BI_RING_NUMA_H
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Memory placement helpers for bi_ring::node_pool. On Linux memory for a NUMA node is
+// mapped fresh and bound with the mbind system call before it is touched, so no libnuma
+// is needed at link time. Elsewhere the node is ignored and memory comes from operator new.
+
+#ifndef BI_RING_MPOL_BIND
+#define BI_RING_MPOL_BIND 2
+#endif
+
+/**
+ * @brief NUMA node of the cpu the calling thread runs on, 0 when it cannot be told
+ */
+inline int bi_ring_numa_current_node(){
+#if defined(__linux__) && defined(SYS_getcpu)
+    unsigned int cpu = 0;
+    unsigned int node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0){
+        return int(node);
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @brief allocates memory placed on a NUMA node
+ *
+ * @param bytes size of the allocation
+ * @param numa_node node to bind the pages to, negative for the default placement
+ * @return void* allocated memory, throws if the node cannot be bound
+ */
+inline void *bi_ring_numa_allocate(size_t bytes, int numa_node){
+#if defined(__linux__) && defined(SYS_mbind)
+    if (numa_node >= 0){
+        void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED){
+            throw bad_alloc();
+        }
+        const size_t bits = 8 * sizeof(unsigned long);
+        vector<unsigned long> mask(numa_node / bits + 1, 0);
+        mask[numa_node / bits] = 1UL << (numa_node % bits);
+        if (syscall(SYS_mbind, memory, bytes, BI_RING_MPOL_BIND, mask.data(), mask.size() * bits, 0) != 0){
+            int error = errno;
+            munmap(memory, bytes);
+            throw runtime_error("Cannot bind memory to NUMA node " + to_string(numa_node) + ": " + strerror(error));
+        }
+        return memory;
+    }
+#endif
+    return ::operator new(bytes);
+}
+
+inline void bi_ring_numa_deallocate(void *memory, size_t bytes, int numa_node){
+#if defined(__linux__) && defined(SYS_mbind)
+    if (numa_node >= 0){
+        munmap(memory, bytes);
+        return;
+    }
+#endif
+    (void)bytes;
+    ::operator delete(memory);
+}
+
+#endif
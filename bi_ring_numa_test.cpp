@@ -0,0 +1,151 @@
+#include "catch2/catch_test_macros.hpp"
+#include "bi_ring.h"
+#include <thread>
+
+TEST_CASE("node pool")
+{
+    bi_ring<int, int>::node_pool pool(-1, 8);
+    CHECK(pool.node() == -1);
+    CHECK(pool.capacity() == 0);
+
+    {
+        bi_ring<int, int> ring(pool);
+        CHECK(ring.get_pool() == &pool);
+        for (int i = 0; i < 20; i++)
+        {
+            ring.push_back(i, i * i);
+        }
+        CHECK(pool.capacity() == 24);
+        CHECK(pool.cached() + pool.pooled() == 4);
+
+        bi_ring<int, int> copy = ring;
+        CHECK(copy.get_pool() == &pool);
+        CHECK(copy == ring);
+
+        ring.compact();
+        CHECK(ring == copy);
+
+        for (int i = 0; i < 10; i++)
+        {
+            ring.pop_front();
+        }
+        CHECK(ring.getLength() == 10);
+        CHECK(ring.cbegin().key() == 10);
+
+        // nodes spliced into a heap ring go back to the pool when erased
+        bi_ring<int, int> heap;
+        heap.splice(heap.cend(), ring);
+        CHECK(heap.getLength() == 10);
+        heap.clear();
+    }
+
+    pool.flush();
+    CHECK(pool.cached() == 0);
+    CHECK(pool.pooled() == pool.capacity());
+}
+
+TEST_CASE("node pools keep separate thread caches")
+{
+    bi_ring<int, int>::node_pool first(-1, 8);
+    bi_ring<int, int>::node_pool second(-1, 8);
+    bi_ring<int, int> a(first);
+    bi_ring<int, int> b(second);
+
+    // alternating between pools keeps both caches instead of flushing on every switch
+    for (int i = 0; i < 4; i++)
+    {
+        a.push_back(i, i);
+        b.push_back(i, i);
+    }
+    CHECK(first.cached() == 4);
+    CHECK(second.cached() == 4);
+    CHECK(first.pooled() == 0);
+    CHECK(second.pooled() == 0);
+
+    a.clear();
+    b.clear();
+    first.flush();
+    CHECK(first.cached() == 0);
+    CHECK(second.cached() == 8);
+    CHECK(first.pooled() == first.capacity());
+}
+
+TEST_CASE("node pool across threads")
+{
+    bi_ring<int, long>::node_pool pool(-1, 16);
+    bi_ring<int, long> rings[4] = {bi_ring<int, long>(pool), bi_ring<int, long>(pool),
+                                   bi_ring<int, long>(pool), bi_ring<int, long>(pool)};
+
+    vector<thread> workers;
+    for (int t = 0; t < 4; t++)
+    {
+        workers.emplace_back([&, t] {
+            for (int i = 0; i < 1000; i++)
+            {
+                rings[t].push_back(i, t);
+                if (i % 3 == 0)
+                {
+                    rings[t].pop_front();
+                }
+            }
+        });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+
+    long sum = 0;
+    for (auto &ring : rings)
+    {
+        CHECK(ring.getLength() == 666);
+        ring.for_each([&](const int &, const long &info) { sum += info; });
+    }
+    CHECK(sum == 666 * (0 + 1 + 2 + 3));
+
+    for (auto &ring : rings)
+    {
+        ring.clear();
+    }
+    pool.flush();
+    CHECK(pool.pooled() == pool.capacity());
+}
+
+TEST_CASE("node pool maps memory in chunks")
+{
+    bi_ring<int, int>::node_pool pool(-1, 64);
+    bi_ring<int, int> ring(pool);
+    ring.push_back(0, 0);
+    size_t chunk = pool.mapped_bytes();
+    CHECK(pool.capacity() == 64);
+
+    // many refills are carved from the first chunk before another one is mapped
+    for (int i = 1; i < 5000; i++)
+    {
+        ring.push_back(i, i);
+    }
+    CHECK(pool.capacity() >= 5000);
+    CHECK(pool.mapped_bytes() == chunk);
+}
+
+TEST_CASE("bind to numa node")
+{
+    int node = bi_ring_numa_current_node();
+    CHECK(node >= 0);
+
+    bi_ring<string, int> ring;
+    ring.bind(node);
+    CHECK(ring.get_pool() == &bi_ring<string, int>::node_pool::for_node(node));
+    CHECK(ring.get_pool()->node() == node);
+    ring.reserve(100);
+    for (int i = 0; i < 100; i++)
+    {
+        ring.push_back(to_string(i), i);
+    }
+    CHECK(ring.getLength() == 100);
+    CHECK(ring.cbegin().key() == "0");
+
+    ring.set_pool(nullptr);
+    ring.push_back("heap", 1);
+    CHECK(ring.getLength() == 101);
+}
@@ -0,0 +1,112 @@
+#ifndef LAB2_BI_RING_PARALLEL_JOIN_H
+#define LAB2_BI_RING_PARALLEL_JOIN_H
+#include "bi_ring.h"
+#include <functional>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief joins two rings on several threads, the equivalent of join() with any aggregate
+ *
+ * A single radix partition pass splits the elements of both rings by key hash into one
+ * bucket per thread. Every thread aggregates its bucket into its own ring, the rings are
+ * then spliced together. Without keep_order keys come out grouped by partition. With it,
+ * the partitions are merged by first occurrence, which costs O(distinct keys * log threads)
+ * extra and gives exactly the order of join(). Key has to be hashable.
+ *
+ * @param first first ring to join
+ * @param second second ring to join
+ * @param threads number of partitions and threads, 0 picks the hardware concurrency
+ * @param aggregate function combining infos of the same key
+ * @param keep_order whether keys keep the order of their first occurrence
+ * @return bi_ring<Key, Info> one element per distinct key
+ */
+template <typename Key, typename Info>
+bi_ring<Key, Info> parallel_join(const bi_ring<Key, Info> &first, const bi_ring<Key, Info> &second, unsigned int threads = 0,
+                                 Info (*aggregate)(const Key &, const Info &, const Info &) = sum_info<Key, Info>,
+                                 bool keep_order = false){
+    struct element {
+        const Key *key;
+        const Info *info;
+        size_t position;
+    };
+
+    if (threads == 0){
+        threads = thread::hardware_concurrency() == 0 ? 1 : thread::hardware_concurrency();
+    }
+
+    // partition pass, elements land in their bucket in input order
+    vector<vector<element>> buckets(threads);
+    for (auto &bucket : buckets){
+        bucket.reserve((first.getLength() + second.getLength()) / threads + 1);
+    }
+    hash<Key> hasher;
+    size_t position = 0;
+    auto partition = [&](const Key &key, const Info &info){
+        size_t h = hasher(key);
+        buckets[(h ^ (h >> 17)) % threads].push_back(element{&key, &info, position++});
+    };
+    first.for_each(partition);
+    second.for_each(partition);
+
+    // aggregation, first_seen holds the input position of every output key for keep_order
+    vector<bi_ring<Key, Info>> parts(threads);
+    vector<vector<size_t>> first_seen(threads);
+
+    auto aggregate_part = [&](unsigned int p){
+        unordered_map<Key, typename bi_ring<Key, Info>::mod_iterator> index;
+        index.reserve(buckets[p].size());
+        for (const element &el : buckets[p]){
+            auto found = index.find(*el.key);
+            if (found == index.end()){
+                index.emplace(*el.key, parts[p].push_back(*el.key, *el.info));
+                if (keep_order){
+                    first_seen[p].push_back(el.position);
+                }
+            }
+            else {
+                found->second.info() = aggregate(*el.key, found->second.info(), *el.info);
+            }
+        }
+    };
+
+    vector<thread> workers;
+    for (unsigned int p = 1; p < threads; p++){
+        workers.emplace_back(aggregate_part, p);
+    }
+    aggregate_part(0);
+    for (auto &worker : workers){
+        worker.join();
+    }
+
+    bi_ring<Key, Info> result;
+    if (!keep_order){
+        for (auto &part : parts){
+            result.splice(result.cend(), part);
+        }
+        return result;
+    }
+
+    // k-way merge of the partition rings by first occurrence
+    vector<size_t> merged(threads, 0);
+    typedef pair<size_t, unsigned int> head;
+    priority_queue<head, vector<head>, greater<head>> heads;
+    for (unsigned int p = 0; p < threads; p++){
+        if (!first_seen[p].empty()){
+            heads.emplace(first_seen[p][0], p);
+        }
+    }
+    while (!heads.empty()){
+        unsigned int p = heads.top().second;
+        heads.pop();
+        result.splice(result.cend(), parts[p], parts[p].cbegin());
+        if (++merged[p] < first_seen[p].size()){
+            heads.emplace(first_seen[p][merged[p]], p);
+        }
+    }
+    return result;
+}
+
+#endif
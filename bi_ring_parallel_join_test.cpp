@@ -0,0 +1,56 @@
+#include "catch2/catch_test_macros.hpp"
+#include "bi_ring_parallel_join.h"
+#include <random>
+
+TEST_CASE("parallel join")
+{
+    bi_ring<string, int> first;
+    first.push_back("uno", 1);
+    first.push_back("due", 2);
+    first.push_back("tre", 3);
+    first.push_back("quattro", 4);
+
+    bi_ring<string, int> second;
+    second.push_back("due", 1);
+    second.push_back("tre", 1);
+    second.push_back("quattro", 3);
+    second.push_back("cinque", 5);
+
+    auto ordered = parallel_join(first, second, 3, sum_info<string, int>, true);
+    CHECK(ordered == join(first, second));
+
+    auto grouped = parallel_join(first, second, 3);
+    CHECK(grouped.getLength() == 5);
+    auto expected = join(first, second);
+    for (auto it = expected.cbegin(); it != expected.cend(); it.next())
+    {
+        auto found = grouped.cbegin();
+        auto from = grouped.cbegin();
+        auto till = grouped.cend();
+        REQUIRE(grouped.find_key(found, it.key(), from, till));
+        CHECK(found.info() == it.info());
+    }
+
+    bi_ring<string, int> empty;
+    CHECK(parallel_join(empty, empty, 4).isEmpty());
+}
+
+TEST_CASE("parallel join matches join")
+{
+    bi_ring<int, long> first;
+    bi_ring<int, long> second;
+    mt19937 gen(11);
+    uniform_int_distribution<int> keys(0, 500);
+    for (int i = 0; i < 3000; i++)
+    {
+        first.push_back(keys(gen), i);
+        second.push_back(keys(gen), 2 * i);
+    }
+
+    auto expected = join(first, second);
+    for (unsigned int threads : {1u, 2u, 5u, 8u})
+    {
+        CHECK(parallel_join(first, second, threads, sum_info<int, long>, true) == expected);
+        CHECK(parallel_join(first, second, threads).getLength() == expected.getLength());
+    }
+}
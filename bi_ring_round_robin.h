@@ -0,0 +1,136 @@
+#ifndef LAB2_BI_RING_ROUND_ROBIN_H
+#define LAB2_BI_RING_ROUND_ROBIN_H
+#include "bi_ring.h"
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+/**
+ * Weighted round-robin over any number of rings, the lazy generalisation of shuffle():
+ * takes weight consecutive elements from a source, then moves on to the next one,
+ * wrapping around every source ring. Each element costs O(1) and no schedule is built.
+ *
+ * Sources with weight 0 or without elements are skipped by keeping the active ones in
+ * a ring of their own. Source rings have to outlive the dispatcher and must not be
+ * modified while it is used.
+ */
+template <typename Key, typename Info>
+class bi_ring_round_robin {
+public:
+    typedef typename bi_ring<Key, Info>::const_iterator const_iterator;
+
+private:
+    // key-only ring of source indices, weights are read from sources
+    typedef bi_ring<unsigned int, tuple<>> active_ring;
+
+    struct source {
+        const bi_ring<Key, Info> *ring;
+        const_iterator position;
+        unsigned int weight;
+        active_ring::mod_iterator active;
+    };
+
+    vector<source> sources;
+    // indices of sources with weight and elements, in visiting order
+    active_ring active;
+    active_ring::mod_iterator turn;
+    unsigned int remaining;
+
+    bool is_active(const source &src){
+        return src.active != active.end();
+    }
+
+    void start_turn(){
+        remaining = active.isEmpty() ? 0 : sources[turn.key()].weight;
+    }
+
+public:
+    bi_ring_round_robin() : turn(active.end()), remaining(0) {}
+
+    bi_ring_round_robin(const bi_ring_round_robin &) = delete;
+    bi_ring_round_robin &operator=(const bi_ring_round_robin &) = delete;
+
+    /**
+     * @brief adds a source visited after all current ones, starting at its first element
+     *
+     * @param ring ring to take elements from
+     * @param weight number of consecutive elements taken per turn
+     * @return unsigned int index of the source, used by set_weight
+     */
+    unsigned int add_source(const bi_ring<Key, Info> &ring, unsigned int weight){
+        unsigned int index = sources.size();
+        sources.push_back(source{&ring, ring.cbegin(), 0, active.end()});
+        set_weight(index, weight);
+        return index;
+    }
+
+    /**
+     * @brief changes the weight of a source, 0 pauses it. A source that becomes active
+     * is visited last in the current round, a running turn is cut to the new weight.
+     *
+     * @param index index returned by add_source
+     * @param weight number of consecutive elements taken per turn
+     */
+    void set_weight(unsigned int index, unsigned int weight){
+        source &src = sources.at(index);
+        src.weight = weight;
+        bool current = !active.isEmpty() && turn == src.active;
+
+        if (weight == 0 || src.ring->isEmpty()){
+            if (is_active(src)){
+                if (current){
+                    ++turn;
+                }
+                active.erase(src.active);
+                src.active = active.end();
+                if (current || active.isEmpty()){
+                    turn = active.isEmpty() ? active.end() : turn;
+                    start_turn();
+                }
+            }
+            return;
+        }
+
+        if (!is_active(src)){
+            src.active = active.insert(turn, index, tuple<>());
+            if (active.getLength() == 1){
+                turn = src.active;
+                start_turn();
+            }
+            return;
+        }
+        if (current && remaining > weight){
+            remaining = weight;
+        }
+    }
+
+    [[nodiscard]] unsigned int weight(unsigned int index) const{
+        return sources.at(index).weight;
+    }
+
+    [[nodiscard]] bool isEmpty() const{
+        return active.isEmpty();
+    }
+
+    /**
+     * @brief next element of the schedule
+     *
+     * @return const_iterator pointing on the element in its source ring
+     */
+    const_iterator next(){
+        if (active.isEmpty()){
+            throw runtime_error("No active sources");
+        }
+
+        source &src = sources[turn.key()];
+        const_iterator element = src.position;
+        src.position++;
+        if (--remaining == 0){
+            ++turn;
+            start_turn();
+        }
+        return element;
+    }
+};
+
+#endif
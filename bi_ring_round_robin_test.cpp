@@ -0,0 +1,94 @@
+#include "catch2/catch_test_macros.hpp"
+#include "bi_ring_round_robin.h"
+
+TEST_CASE("round robin matches shuffle")
+{
+    bi_ring<string, int> first;
+    first.push_back("uno", 1);
+    first.push_back("due", 2);
+    first.push_back("tre", 3);
+
+    bi_ring<string, int> second;
+    second.push_back("quattro", 4);
+    second.push_back("cinque", 5);
+
+    bi_ring_round_robin<string, int> dispatcher;
+    dispatcher.add_source(first, 2);
+    dispatcher.add_source(second, 3);
+
+    auto expected = shuffle(first, 2, second, 3, 4);
+    for (auto it = expected.cbegin(); it != expected.cend(); it.next())
+    {
+        auto element = dispatcher.next();
+        CHECK(element.key() == it.key());
+        CHECK(element.info() == it.info());
+    }
+}
+
+TEST_CASE("round robin weights")
+{
+    bi_ring<int, int> a;
+    bi_ring<int, int> b;
+    bi_ring<int, int> c;
+    bi_ring<int, int> empty;
+    a.push_back(1, 0);
+    b.push_back(2, 0);
+    c.push_back(3, 0);
+
+    bi_ring_round_robin<int, int> dispatcher;
+    CHECK(dispatcher.isEmpty());
+    CHECK_THROWS(dispatcher.next());
+
+    unsigned int ia = dispatcher.add_source(a, 1);
+    unsigned int ib = dispatcher.add_source(b, 0);
+    unsigned int ic = dispatcher.add_source(c, 2);
+    unsigned int ie = dispatcher.add_source(empty, 5);
+    CHECK(dispatcher.weight(ib) == 0);
+    CHECK(dispatcher.weight(ie) == 5);
+
+    // empty and zero weight sources are skipped
+    CHECK(dispatcher.next().key() == 1);
+    CHECK(dispatcher.next().key() == 3);
+    CHECK(dispatcher.next().key() == 3);
+    CHECK(dispatcher.next().key() == 1);
+
+    // a resumed source joins at the end of the current round
+    dispatcher.set_weight(ib, 1);
+    CHECK(dispatcher.next().key() == 3);
+    CHECK(dispatcher.next().key() == 3);
+    CHECK(dispatcher.next().key() == 1);
+    CHECK(dispatcher.next().key() == 2);
+
+    // pausing the running source moves on to the next one
+    CHECK(dispatcher.next().key() == 3);
+    dispatcher.set_weight(ic, 0);
+    CHECK(dispatcher.next().key() == 1);
+    CHECK(dispatcher.next().key() == 2);
+
+    // raising the weight applies from the next turn, lowering it cuts the running one
+    dispatcher.set_weight(ic, 3);
+    dispatcher.set_weight(ia, 4);
+    CHECK(dispatcher.next().key() == 1);
+    CHECK(dispatcher.next().key() == 2);
+    CHECK(dispatcher.next().key() == 3);
+    dispatcher.set_weight(ic, 1);
+    CHECK(dispatcher.weight(ic) == 1);
+    CHECK(dispatcher.next().key() == 3);
+    CHECK(dispatcher.next().key() == 1);
+    CHECK(dispatcher.next().key() == 1);
+    CHECK(dispatcher.next().key() == 1);
+    CHECK(dispatcher.next().key() == 1);
+    CHECK(dispatcher.next().key() == 2);
+    CHECK(dispatcher.next().key() == 3);
+
+    dispatcher.set_weight(ia, 0);
+    dispatcher.set_weight(ib, 0);
+    dispatcher.set_weight(ic, 0);
+    CHECK(dispatcher.isEmpty());
+    CHECK_THROWS(dispatcher.next());
+
+    dispatcher.set_weight(ib, 2);
+    CHECK(dispatcher.next().key() == 2);
+    CHECK(dispatcher.next().key() == 2);
+    CHECK(dispatcher.next().key() == 2);
+}
@@ -0,0 +1,264 @@
+#ifndef LAB2_BI_RING_STATIC_H
+#define LAB2_BI_RING_STATIC_H
+#include "bi_ring.h"
+#include <stdexcept>
+
+/**
+ * Fixed-capacity ring with every operation constexpr, so lookup tables can be built
+ * at compile time and placed in read-only data. Nodes live in arrays inside the object
+ * and are linked by index, index 0 is the sentinel.
+ *
+ * Key and Info have to be literal types in C++17 (integers, const char *, string_view).
+ * C++20 builds also accept types with constexpr allocation, such as string, as long as
+ * the ring does not outlive the constant evaluation.
+ */
+template <typename Key, typename Info, unsigned int Capacity>
+class bi_ring_static {
+private:
+    Key keys[Capacity + 1]{};
+    Info infos[Capacity + 1]{};
+    unsigned int nexts[Capacity + 1]{};
+    unsigned int prevs[Capacity + 1]{};
+    unsigned int length = 0;
+
+    constexpr unsigned int link(unsigned int position, const Key &key, const Info &info){
+        if (length == Capacity){
+            throw runtime_error("Ring is full");
+        }
+        unsigned int node = ++length;
+        keys[node] = key;
+        infos[node] = info;
+        nexts[node] = position;
+        prevs[node] = prevs[position];
+        nexts[prevs[position]] = node;
+        prevs[position] = node;
+        return node;
+    }
+
+public:
+    class const_iterator {
+    private:
+        friend class bi_ring_static;
+
+        const bi_ring_static *ring;
+        unsigned int node;
+
+        constexpr const_iterator(const bi_ring_static *ring, unsigned int node): ring(ring), node(node) {}
+
+    public:
+        constexpr bool operator==(const const_iterator &other) const{
+            return node == other.node;
+        }
+
+        constexpr bool operator!=(const const_iterator &other) const{
+            return node != other.node;
+        }
+
+        constexpr const_iterator &operator++(){
+            next();
+            if (node == 0){
+                next();
+            }
+            return *this;
+        }
+
+        constexpr const_iterator operator++(int){
+            const_iterator temp = *this;
+            ++*this;
+            return temp;
+        }
+
+        constexpr const_iterator &operator--(){
+            prev();
+            if (node == 0){
+                prev();
+            }
+            return *this;
+        }
+
+        constexpr const_iterator operator--(int){
+            const_iterator temp = *this;
+            --*this;
+            return temp;
+        }
+
+        constexpr const_iterator &next(){
+            node = ring->nexts[node];
+            return *this;
+        }
+
+        constexpr const_iterator &prev(){
+            node = ring->prevs[node];
+            return *this;
+        }
+
+        constexpr const_iterator get_next() const{
+            return const_iterator(ring, ring->nexts[node]);
+        }
+
+        constexpr const Key &key() const{
+            return ring->keys[node];
+        }
+
+        constexpr const Info &info() const{
+            return ring->infos[node];
+        }
+    };
+
+    constexpr bi_ring_static() = default;
+
+    [[nodiscard]] constexpr unsigned int getLength() const{
+        return length;
+    }
+
+    [[nodiscard]] constexpr bool isEmpty() const{
+        return length == 0;
+    }
+
+    [[nodiscard]] static constexpr unsigned int capacity(){
+        return Capacity;
+    }
+
+    /**
+     * @brief inserts element in the end of the ring, throws if the ring is full
+     *
+     * @param key is the key that will be inserted
+     * @param info is info that will be inserted
+     * @return iterator pointing on inserted element
+     */
+    constexpr const_iterator push_back(const Key &key, const Info &info){
+        return const_iterator(this, link(0, key, info));
+    }
+
+    /**
+     * @brief inserts element in the beginning of the ring, throws if the ring is full
+     *
+     * @param key is the key that will be inserted
+     * @param info is info that will be inserted
+     * @return iterator pointing on inserted element
+     */
+    constexpr const_iterator push_front(const Key &key, const Info &info){
+        return const_iterator(this, link(nexts[0], key, info));
+    }
+
+    /**
+     * Searches for the specified element of a given key.
+     *
+     * @param [out] it is iterator pointing on found element
+     * @param key The key to search for.
+     * @param search_from iterator pointing on element from which start searching
+     * @param search_till iterator pointing on element until which element to search
+     * @return true if element found
+     */
+    constexpr bool find_key(const_iterator &it, const Key &key, const_iterator &search_from, const_iterator &search_till) const{
+        for (; search_from != search_till; search_from.next()){
+            if (search_from.node == 0){
+                continue;
+            }
+            if (search_from.key() == key){
+                it = search_from;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    constexpr unsigned int occurrencesOf(const Key &key) const{
+        unsigned int counter = 0;
+        for (auto it = cbegin(); it != cend(); it.next()){
+            if (it.key() == key){
+                counter++;
+            }
+        }
+        return counter;
+    }
+
+    constexpr const_iterator cbegin() const{
+        return const_iterator(this, nexts[0]);
+    }
+
+    constexpr const_iterator cend() const{
+        return const_iterator(this, 0);
+    }
+
+    /**
+     * @brief copies the table into a heap allocated bi_ring
+     */
+    bi_ring<Key, Info> to_ring() const{
+        bi_ring<Key, Info> result;
+        result.reserve(length);
+        for (auto it = cbegin(); it != cend(); it.next()){
+            result.push_back(it.key(), it.info());
+        }
+        return result;
+    }
+};
+
+template <typename Key, typename Info, unsigned int Capacity>
+constexpr bi_ring_static<Key, Info, Capacity> filter(const bi_ring_static<Key, Info, Capacity> &source, bool (*pred)(const Key &)){
+    bi_ring_static<Key, Info, Capacity> result;
+
+    for (auto it = source.cbegin(); it != source.cend(); it.next()){
+        if (pred(it.key())){
+            result.push_back(it.key(), it.info());
+        }
+    }
+
+    return result;
+}
+
+template <typename Key, typename Info, unsigned int Capacity>
+constexpr bi_ring_static<Key, Info, Capacity> unique(const bi_ring_static<Key, Info, Capacity> &src, Info (*aggregate)(const Key &, const Info &, const Info &)) {
+    bi_ring_static<Key, Info, Capacity> result;
+
+    for (auto it = src.cbegin(); it != src.cend(); it.next()) {
+        auto search_res = result.cbegin();
+        auto sf = result.cbegin();
+        auto st = result.cend();
+
+        if (result.find_key(search_res, it.key(), sf, st)) {
+            continue;
+        }
+
+        auto searching_it = src.cbegin();
+        auto search_from = it.get_next();
+        auto search_till = src.cend();
+        Info new_info = it.info();
+
+        while (src.find_key(searching_it, it.key(), search_from, search_till)) {
+            new_info = aggregate(it.key(), new_info, searching_it.info());
+            search_from.next();
+        }
+
+        result.push_back(it.key(), new_info);
+    }
+
+    return result;
+}
+
+/**
+ * Interleaves two rings like shuffle() for bi_ring. The result capacity is given
+ * explicitly, exceeding it throws, which fails compilation in a constant expression.
+ */
+template <unsigned int ResultCapacity, typename Key, typename Info, unsigned int FirstCapacity, unsigned int SecondCapacity>
+constexpr bi_ring_static<Key, Info, ResultCapacity> shuffle(const bi_ring_static<Key, Info, FirstCapacity> &first, unsigned int fcnt,
+                                                            const bi_ring_static<Key, Info, SecondCapacity> &second, unsigned int scnt, unsigned int reps){
+    bi_ring_static<Key, Info, ResultCapacity> result;
+
+    auto first_it = first.cbegin();
+    auto second_it = second.cbegin();
+
+    for (unsigned int rep = 0; rep < reps; rep++) {
+        for (unsigned int i = 0; i < fcnt; i++, first_it++) {
+            result.push_back(first_it.key(), first_it.info());
+        }
+
+        for (unsigned int i = 0; i < scnt; i++, second_it++) {
+            result.push_back(second_it.key(), second_it.info());
+        }
+    }
+
+    return result;
+}
+
+#endif
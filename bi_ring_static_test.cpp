@@ -0,0 +1,99 @@
+#include "catch2/catch_test_macros.hpp"
+#include "bi_ring_static.h"
+#include <string_view>
+
+typedef bi_ring_static<string_view, int, 8> route_table;
+
+constexpr route_table make_routes()
+{
+    route_table routes;
+    routes.push_back("uno", 1);
+    routes.push_back("due", 2);
+    routes.push_back("uno", 3);
+    routes.push_back("quattro", 4);
+    routes.push_front("zero", 0);
+    return routes;
+}
+
+constexpr bool long_key(const string_view &key)
+{
+    return key.size() > 3;
+}
+
+// built at compile time, ends up in read-only data
+static constexpr route_table routes = make_routes();
+static constexpr auto long_routes = filter(routes, long_key);
+static constexpr auto unique_routes = unique(routes, sum_info<string_view, int>);
+
+static_assert(routes.getLength() == 5);
+static_assert(routes.occurrencesOf("uno") == 2);
+static_assert(routes.cbegin().key() == "zero");
+static_assert(long_routes.getLength() == 2);
+static_assert(unique_routes.getLength() == 4);
+
+constexpr int find_info(const route_table &table, string_view key)
+{
+    auto it = table.cbegin();
+    auto from = table.cbegin();
+    auto till = table.cend();
+    return table.find_key(it, key, from, till) ? it.info() : -1;
+}
+
+static_assert(find_info(unique_routes, "uno") == 4);
+static_assert(find_info(routes, "cinque") == -1);
+
+constexpr auto make_schedule()
+{
+    bi_ring_static<string_view, int, 2> first;
+    first.push_back("a", 1);
+    first.push_back("b", 2);
+    bi_ring_static<string_view, int, 3> second;
+    second.push_back("x", 1);
+    second.push_back("y", 2);
+    second.push_back("z", 3);
+    return shuffle<6>(first, 1, second, 2, 2);
+}
+
+static_assert(make_schedule().getLength() == 6);
+static_assert((--make_schedule().cend()).key() == "x");
+
+TEST_CASE("static ring at runtime")
+{
+    string_view expected[] = {"zero", "uno", "due", "quattro"};
+    int infos[] = {0, 4, 2, 4};
+    int i = 0;
+    for (auto it = unique_routes.cbegin(); it != unique_routes.cend(); it.next())
+    {
+        CHECK(it.key() == expected[i]);
+        CHECK(it.info() == infos[i]);
+        i++;
+    }
+    CHECK(i == 4);
+
+    auto ring = routes.to_ring();
+    CHECK(ring.getLength() == 5);
+    CHECK(ring.occurrencesOf("uno") == 2);
+
+    bi_ring_static<int, int, 1> tiny;
+    tiny.push_back(1, 1);
+    CHECK_THROWS(tiny.push_back(2, 2));
+
+    auto it = routes.cbegin();
+    --it;
+    CHECK(it.key() == "quattro");
+    ++it;
+    CHECK(it.key() == "zero");
+}
+
+#if __cplusplus >= 202002L
+constexpr unsigned int string_table_occurrences()
+{
+    bi_ring_static<string, int, 4> table;
+    table.push_back("uno", 1);
+    table.push_back("due", 2);
+    table.push_back("uno", 3);
+    return table.occurrencesOf("uno");
+}
+
+static_assert(string_table_occurrences() == 2);
+#endif
@@ -1,6 +1,7 @@
 #include "catch2/catch_test_macros.hpp"
 #include "bi_ring.h"
 #include <iostream>
+#include <memory>
 
 typedef bi_ring<int, string> ring;
 
@@ -562,3 +563,506 @@ TEST_CASE("shuffle")
         it.next();
     }
 }
+
+TEST_CASE("compact")
+{
+    bi_ring<int, string> ring;
+    for (int i = 0; i < 50; i++)
+    {
+        ring.push_back(i, to_string(i));
+    }
+    // scramble ring order against allocation order
+    for (int i = 0; i < 50; i += 2)
+    {
+        auto it = ring.cbegin();
+        ring.erase(it);
+        ring.push_back(i + 100, to_string(i + 100));
+    }
+    bi_ring<int, string> before = ring;
+
+    ring.compact();
+    CHECK(ring.getLength() == 50);
+    CHECK(ring == before);
+
+    // nodes now follow ring order in memory
+    const int *prev = nullptr;
+    for (auto it = ring.cbegin(); it != ring.cend(); it.next())
+    {
+        if (prev != nullptr)
+        {
+            CHECK(&it.key() > prev);
+        }
+        prev = &it.key();
+    }
+
+    // ring stays usable, erased compacted nodes are reused
+    ring.pop_front();
+    ring.push_back(999, "last");
+    CHECK(ring.getLength() == 50);
+    CHECK((--ring.cend()).key() == 999);
+    CHECK(ring.cbegin().key() == 26);
+
+    bi_ring<int, string> empty;
+    empty.compact();
+    CHECK(empty.isEmpty());
+}
+
+TEST_CASE("for each")
+{
+    bi_ring<int, string> ring;
+    for (int i = 1; i <= 10; i++)
+    {
+        ring.push_back(i, "A");
+    }
+
+    int sum = 0;
+    int expected = 1;
+    const auto &cring = ring;
+    cring.for_each([&](const int &key, const string &) {
+        CHECK(key == expected++);
+        sum += key;
+    });
+    CHECK(sum == 55);
+
+    ring.for_each([](const int &key, string &info) {
+        info = to_string(key);
+    });
+    CHECK(ring.cbegin().info() == "1");
+    CHECK((--ring.cend()).info() == "10");
+}
+
+TEST_CASE("reserve")
+{
+    bi_ring<int, string> ring;
+    ring.reserve(10);
+    for (int i = 0; i < 10; i++)
+    {
+        ring.push_back(i, "A");
+    }
+
+    // reserved nodes come out of one block in order
+    const int *prev = nullptr;
+    for (auto it = ring.cbegin(); it != ring.cend(); it.next())
+    {
+        if (prev != nullptr)
+        {
+            CHECK(&it.key() > prev);
+        }
+        prev = &it.key();
+    }
+
+    // erased nodes are handed out again
+    const int *first = &ring.cbegin().key();
+    ring.pop_front();
+    CHECK(&ring.push_back(10, "B").key() == first);
+
+    ring.reserve(5); // already enough room
+    CHECK(ring.getLength() == 10);
+
+    // infos are destroyed when erased, with or without checked iterators
+    auto shared = make_shared<int>(1);
+    bi_ring<int, shared_ptr<int>> owners;
+    owners.push_back(1, shared);
+    owners.reserve(4);
+    owners.push_back(2, shared);
+    CHECK(shared.use_count() == 3);
+    owners.pop_front();
+    owners.pop_front();
+    CHECK(shared.use_count() == 1);
+}
+
+TEST_CASE("splice")
+{
+    bi_ring<int, string> ring;
+    for (int i = 1; i <= 5; i++)
+    {
+        ring.push_back(i, to_string(i));
+    }
+
+    // single element within the ring, the node is not reallocated
+    const int *node = &(--ring.cend()).key();
+    auto moved = ring.splice(ring.cbegin(), --ring.cend());
+    CHECK(&moved.key() == node);
+    int order[] = {5, 1, 2, 3, 4};
+    int i = 0;
+    for (auto it = ring.cbegin(); it != ring.cend(); it.next())
+    {
+        CHECK(it.key() == order[i++]);
+    }
+
+    // range to another ring
+    bi_ring<int, string> other;
+    CHECK(other.splice(other.cend(), ring, ++ring.cbegin(), 3) == 3);
+    CHECK(ring.getLength() == 2);
+    CHECK(other.getLength() == 3);
+    CHECK(other.cbegin().key() == 1);
+    CHECK((--other.cend()).key() == 3);
+    CHECK((--ring.cend()).key() == 4);
+
+    // range trimmed to the end of the ring
+    CHECK(other.splice(other.cbegin(), ring, ++ring.cbegin(), 10) == 1);
+    CHECK(other.cbegin().key() == 4);
+    CHECK(other.splice(other.cbegin(), ring, ring.cend(), 10) == 0);
+
+    // whole ring
+    other.splice(other.cend(), ring);
+    CHECK(ring.isEmpty());
+    CHECK(other.getLength() == 5);
+    CHECK((--other.cend()).key() == 5);
+    ring.push_back(6, "6");
+    CHECK(ring.getLength() == 1);
+}
+
+TEST_CASE("join all")
+{
+    vector<bi_ring<string, int>> partitions(4);
+    string keys[] = {"uno", "due", "tre", "quattro", "cinque"};
+    for (int p = 0; p < 4; p++)
+    {
+        for (int i = p; i < 5; i++)
+        {
+            partitions[p].push_back(keys[i], p + 1);
+        }
+    }
+
+    vector<const bi_ring<string, int> *> rings;
+    for (auto &partition : partitions)
+    {
+        rings.push_back(&partition);
+    }
+
+    auto res = join_all(rings);
+    auto chained = join(join(join(partitions[0], partitions[1]), partitions[2]), partitions[3]);
+    CHECK(res == chained);
+    CHECK(res.getLength() == 5);
+    CHECK((--res.cend()).info() == 10);
+
+    bi_ring<int, string> fr, en;
+    fr.push_back(1, "un");
+    fr.push_back(2, "deux");
+    en.push_back(2, "two");
+    en.push_back(1, "one");
+    const bi_ring<int, string> *languages[] = {&fr, &en};
+    auto concatenated = join_all(languages, 2, _concatenate_info<int, string>);
+    CHECK(concatenated.cbegin().info() == "un-one");
+    CHECK((--concatenated.cend()).info() == "deux-two");
+
+    CHECK(join_all(rings.data(), 0).isEmpty());
+    CHECK(join_all(rings.data(), 1) == partitions[0]);
+
+#ifdef __cpp_lib_span
+    CHECK(join_all(span<const bi_ring<string, int> *>(rings)) == res);
+    CHECK(join_all(span<const bi_ring<string, int> *const>(rings.data(), 2)) == join(partitions[0], partitions[1]));
+    span<const bi_ring<int, string> *, 2> fixed(languages);
+    CHECK(join_all(fixed, _concatenate_info<int, string>) == concatenated);
+#endif
+}
+
+TEST_CASE("count keys")
+{
+    ring r;
+    for (int i = 0; i < 100; i++)
+    {
+        r.push_back(i % 10, to_string(i));
+    }
+
+    vector<int> small = {3, 42, 3, 0};
+    auto counts = r.count_keys(small);
+    CHECK(counts == vector<unsigned int>{10, 0, 10, 10});
+
+    vector<int> large;
+    for (int i = -5; i < 30; i++)
+    {
+        large.push_back(i);
+    }
+    counts = r.count_keys(large.data(), large.size());
+    REQUIRE(counts.size() == large.size());
+    for (size_t i = 0; i < large.size(); i++)
+    {
+        CHECK(counts[i] == r.occurrencesOf(large[i]));
+    }
+
+#ifdef __cpp_lib_span
+    CHECK(r.count_keys(span<const int>(small)) == vector<unsigned int>{10, 0, 10, 10});
+#endif
+    CHECK(r.count_keys(nullptr, 0).empty());
+    CHECK(ring().count_keys(small) == vector<unsigned int>{0, 0, 0, 0});
+}
+
+TEST_CASE("find keys")
+{
+    ring r;
+    for (int i = 0; i < 100; i++)
+    {
+        r.push_back(i % 25, to_string(i));
+    }
+
+    vector<int> small = {7, 99, 0, 7};
+    auto found = r.find_keys(small);
+    REQUIRE(found.size() == 4);
+    CHECK(found[0].info() == "7");
+    CHECK(found[1] == r.cend());
+    CHECK(found[2].info() == "0");
+    CHECK(found[3] == found[0]);
+
+    vector<int> large;
+    for (int i = 40; i >= -10; i--)
+    {
+        large.push_back(i);
+    }
+    found = r.find_keys(large);
+    for (size_t i = 0; i < large.size(); i++)
+    {
+        auto it = r.cbegin();
+        auto from = r.cbegin();
+        auto till = r.cend();
+        if (r.find_key(it, large[i], from, till))
+        {
+            CHECK(found[i] == it);
+        }
+        else
+        {
+            CHECK(found[i] == r.cend());
+        }
+    }
+}
+
+TEST_CASE("fingerprint")
+{
+    ring built;
+    for (int i = 0; i < 20; i++)
+    {
+        built.push_back(i, to_string(i));
+    }
+
+    // same content reached through inserts, erases and splices
+    ring other;
+    ring scratch;
+    for (int i = 19; i >= 0; i -= 2)
+    {
+        other.push_front(i, to_string(i));
+    }
+    for (int i = 18; i >= 0; i -= 2)
+    {
+        scratch.push_back(i, to_string(i));
+    }
+    for (auto it = other.cbegin(); it != other.cend(); it.next())
+    {
+        other.splice(it, scratch, --scratch.cend());
+    }
+    CHECK(scratch.isEmpty());
+    CHECK(other.fingerprint() == built.fingerprint());
+    CHECK(other == built);
+    CHECK_FALSE(other != built);
+
+    // the incremental hash matches a full rehash
+    ring rehashed = built;
+    rehashed.invalidate_fingerprint();
+    CHECK(rehashed.fingerprint() == built.fingerprint());
+
+    other.push_back(100, "x");
+    other.insert(other.cbegin() + 3, 200, "y");
+    CHECK(other.fingerprint() != built.fingerprint());
+    CHECK(other != built);
+    other.pop_back();
+    other.erase(other.cbegin() + 3);
+    CHECK(other.fingerprint() == built.fingerprint());
+
+    scratch.push_back(7, "7");
+    CHECK(scratch != built);
+    CHECK(scratch.fingerprint() != ring().fingerprint());
+    scratch.clear();
+    CHECK(scratch.fingerprint() == ring().fingerprint());
+
+    // order matters
+    ring swapped = built;
+    swapped.splice(swapped.cbegin(), swapped, swapped.cbegin() + 1);
+    CHECK(swapped.fingerprint() != built.fingerprint());
+    CHECK(swapped != built);
+
+    // range and whole ring splices
+    ring tail;
+    tail.splice(tail.cend(), other, other.cbegin() + 10, 10);
+    CHECK(other.getLength() == 10);
+    other.splice(other.cend(), tail);
+    CHECK(other.fingerprint() == built.fingerprint());
+    CHECK(tail.fingerprint() == ring().fingerprint());
+
+    // in place changes through assign or iterator writes
+    other.assign(other.cbegin(), 0, "changed");
+    CHECK(other != built);
+    CHECK(other.fingerprint() != built.fingerprint());
+    other.assign(other.cbegin(), 0, "0");
+    CHECK(other.fingerprint() == built.fingerprint());
+    other.assign(other.cbegin() + 5, 5, "changed");
+    CHECK(other.fingerprint() != built.fingerprint());
+    ring::mod_iterator it = other.begin() + 5;
+    it.info() = "5";
+    CHECK(other.fingerprint() == built.fingerprint());
+    CHECK(other == built);
+    other.for_each([](const int &, const string &) {});
+    CHECK(other == built);
+    other.for_each([](const int &, string &info) { info += "!"; });
+    CHECK(other.fingerprint() != built.fingerprint());
+
+    // writes through a mod_iterator are seen by operator== without an invalidate
+    ring x;
+    ring y;
+    x.push_back(1, "x");
+    x.push_back(2, "y");
+    y.push_back(1, "x");
+    y.push_back(2, "z");
+    CHECK(x != y);
+    (--y.end()).info() = "y";
+    CHECK(x == y);
+    CHECK_FALSE(x != y);
+
+    ring filled;
+    ring expected;
+    for (int i = 0; i < 10; i++)
+    {
+        filled.push_back(i, "");
+        expected.push_back(i, to_string(i));
+    }
+    CHECK(filled != expected);
+    for (auto write = filled.begin(); write != filled.end(); write.next())
+    {
+        write.info() = to_string(write.key());
+    }
+    CHECK(filled == expected);
+    CHECK(filled.fingerprint() == expected.fingerprint());
+
+    // same neighbour pairs in a different order
+    ring a;
+    ring b;
+    for (int key : {1, 2, 1, 3, 1})
+    {
+        a.push_back(key, "");
+    }
+    for (int key : {1, 3, 1, 2, 1})
+    {
+        b.push_back(key, "");
+    }
+    CHECK(a.fingerprint() != b.fingerprint());
+    CHECK(a != b);
+
+    // end operations keep the hash current, compare with a full rehash
+    ring ends;
+    for (int i = 0; i < 200; i++)
+    {
+        switch (i % 5)
+        {
+        case 0:
+        case 1:
+            ends.push_back(i, to_string(i));
+            break;
+        case 2:
+            ends.push_front(i, to_string(i));
+            break;
+        case 3:
+            ends.pop_front();
+            break;
+        default:
+            ends.pop_back();
+            ends.push_back(-i, "x");
+        }
+        ring copy = ends;
+        copy.invalidate_fingerprint();
+        REQUIRE(ends.fingerprint() == copy.fingerprint());
+    }
+
+    // rings of unhashable types still compare
+    bi_ring<int, vector<int>> lists;
+    lists.push_back(1, {1, 2});
+    bi_ring<int, vector<int>> copy = lists;
+    CHECK((lists == copy));
+    copy.push_back(2, {});
+    CHECK((lists != copy));
+}
+
+TEST_CASE("raw iterators")
+{
+    bi_ring<int, string> ring;
+    for (int i = 1; i <= 3; i++)
+    {
+        ring.push_back(i, "A");
+    }
+
+    // raw iterators stop at the sentinel instead of jumping over it
+    int i = 1;
+    bi_ring<int, string>::const_raw_iterator it = ring.cbegin();
+    for (; it != ring.cend(); ++it)
+    {
+        CHECK(it.key() == i++);
+    }
+    CHECK(i == 4);
+    CHECK(it == ring.cend());
+
+    bi_ring<int, string>::mod_raw_iterator last = --ring.end();
+    CHECK(last.key() == 3);
+    last.info() = "B";
+    ring.erase(last);
+    CHECK(ring.getLength() == 2);
+
+    // wrapping iterators go round
+    bi_ring<int, string>::const_iterator wrap = --ring.cend();
+    ++wrap;
+    CHECK(wrap.key() == 1);
+}
+
+#if BI_RING_CHECKED_ITERATORS
+TEST_CASE("checked iterators")
+{
+    bi_ring<int, string> ring;
+    bi_ring<int, string> other;
+    ring.push_back(1, "one");
+    ring.push_back(2, "two");
+    other.push_back(3, "three");
+
+    // iterator of a different ring
+    CHECK_THROWS(ring.erase(other.cbegin()));
+    CHECK_THROWS(ring.insert(other.cbegin(), 4, "four"));
+    CHECK(ring.getLength() == 2);
+    CHECK(other.getLength() == 1);
+
+    // use after erase
+    auto stale = ring.cbegin();
+    ring.erase(stale);
+    CHECK_THROWS(stale.key());
+    CHECK_THROWS(stale.next());
+    CHECK_THROWS(ring.erase(stale));
+    CHECK(ring.getLength() == 1);
+
+    // spliced elements belong to their new ring
+    auto moved = other.splice(other.cend(), ring, ring.cbegin());
+    CHECK(moved.key() == 2);
+    CHECK(ring.isEmpty());
+    CHECK_NOTHROW(other.erase(moved));
+
+    // use after clear and assignment
+    auto cleared = other.cbegin();
+    other.clear();
+    CHECK_THROWS(cleared.key());
+    other.push_back(5, "five");
+    auto assigned = other.cbegin();
+    other = ring;
+    CHECK_THROWS(assigned.info());
+
+    // use after compact, of heap nodes and of reserved block slots
+    bi_ring<int, string> heap;
+    heap.push_back(1, "one");
+    heap.push_back(2, "two");
+    auto before_compact = heap.cbegin();
+    heap.compact();
+    CHECK_THROWS(before_compact.key());
+
+    bi_ring<int, string> reserved;
+    reserved.reserve(4);
+    reserved.push_back(1, "one");
+    reserved.push_back(2, "two");
+    auto in_block = --reserved.cend();
+    reserved.compact();
+    CHECK_THROWS(in_block.key());
+    CHECK(reserved.cbegin().key() == 1);
+}
+#endif
@@ -0,0 +1,140 @@
+#ifndef LAB2_BI_RING_WINDOW_H
+#define LAB2_BI_RING_WINDOW_H
+#include "bi_ring.h"
+#include <stdexcept>
+#include <vector>
+
+template <typename Key, typename Info>
+Info subtract_info(const Key &, const Info &total, const Info &removed){
+    return total - removed;
+}
+
+/**
+ * Aggregate of the last width elements of a ring, maintained in amortized O(1) per
+ * push_back and pop_front. The ring holds exactly the window, older elements are popped.
+ *
+ * With an inverse function the aggregate is kept as one running total. Without it the
+ * window is split in two stacks: suffix totals of the older part and one running total
+ * of the newer part, so any associative aggregate (max, min, ...) works.
+ *
+ * The key passed to aggregate is the key of one of the combined elements. While the
+ * window is attached the ring must only be modified through it.
+ */
+template <typename Key, typename Info>
+class bi_ring_window {
+public:
+    typedef Info (*aggregate_function)(const Key &, const Info &, const Info &);
+
+private:
+    bi_ring<Key, Info> &elements;
+    unsigned int width;
+    aggregate_function aggregate;
+    aggregate_function inverse;
+
+    // totals of the older elements from each one to the end of the older part, first element last
+    vector<Info> front_totals;
+    Info back_total;
+    unsigned int back_count;
+
+    void fold_back(const Key &key, const Info &info){
+        back_total = back_count == 0 ? info : aggregate(key, back_total, info);
+        back_count++;
+    }
+
+    // moves every element to the older part, walking from the newest one
+    void flip(){
+        auto it = --elements.cend();
+        front_totals.reserve(back_count);
+        for (unsigned int i = 0; i < back_count; i++, it.prev()){
+            front_totals.push_back(front_totals.empty() ? it.info() : aggregate(it.key(), it.info(), front_totals.back()));
+        }
+        back_count = 0;
+    }
+
+public:
+    /**
+     * Attaches to the ring, popping elements from its front until at most width are left.
+     *
+     * @param ring ring holding the window, has to outlive the window
+     * @param width number of most recent elements aggregated
+     * @param aggregate associative function combining two infos
+     * @param inverse function removing an info from a total, nullptr if there is none
+     */
+    bi_ring_window(bi_ring<Key, Info> &ring, unsigned int width, aggregate_function aggregate, aggregate_function inverse = nullptr)
+        : elements(ring), width(width), aggregate(aggregate), inverse(inverse), back_total(), back_count(0)
+    {
+        if (width == 0){
+            throw runtime_error("Window width must be positive");
+        }
+        while (elements.getLength() > width){
+            elements.pop_front();
+        }
+        elements.for_each([&](const Key &key, const Info &info){
+            fold_back(key, info);
+        });
+    }
+
+    /**
+     * @brief appends element to the window, dropping the oldest one when the window is full
+     *
+     * @param key is the key that will be inserted
+     * @param info is info that will be inserted
+     */
+    void push_back(const Key &key, const Info &info){
+        elements.push_back(key, info);
+        fold_back(key, info);
+        if (elements.getLength() > width){
+            pop_front();
+        }
+    }
+
+    /**
+     * @brief removes the oldest element of the window
+     */
+    void pop_front(){
+        if (elements.isEmpty()){
+            return;
+        }
+
+        if (inverse != nullptr){
+            auto oldest = elements.cbegin();
+            back_count--;
+            back_total = back_count == 0 ? Info() : inverse(oldest.key(), back_total, oldest.info());
+        }
+        else {
+            if (front_totals.empty()){
+                flip();
+            }
+            front_totals.pop_back();
+        }
+        elements.pop_front();
+    }
+
+    /**
+     * @brief aggregate of all elements in the window
+     *
+     * @return Info aggregate of the window, oldest element first
+     */
+    Info value() const{
+        if (elements.isEmpty()){
+            throw runtime_error("Window is empty");
+        }
+        if (front_totals.empty()){
+            return back_total;
+        }
+        if (back_count == 0){
+            return front_totals.back();
+        }
+        return aggregate((--elements.cend()).key(), front_totals.back(), back_total);
+    }
+
+    [[nodiscard]] unsigned int getWidth() const{
+        return width;
+    }
+
+    [[nodiscard]] unsigned int getLength() const{
+        return elements.getLength();
+    }
+};
+
+#endif
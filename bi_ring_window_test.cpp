@@ -0,0 +1,95 @@
+#include "catch2/catch_test_macros.hpp"
+#include "bi_ring_window.h"
+#include <random>
+
+template <typename Key, typename Info>
+Info max_info(const Key &, const Info &i1, const Info &i2)
+{
+    return i1 < i2 ? i2 : i1;
+}
+
+template <typename Key, typename Info>
+Info _concatenate_window(const Key &, const Info &i1, const Info &i2)
+{
+    return i1 + "-" + i2;
+}
+
+TEST_CASE("window sum with inverse")
+{
+    bi_ring<string, int> ring;
+    bi_ring_window<string, int> window(ring, 3, sum_info<string, int>, subtract_info<string, int>);
+
+    CHECK_THROWS(window.value());
+    window.push_back("uno", 1);
+    CHECK(window.value() == 1);
+    window.push_back("due", 2);
+    window.push_back("tre", 3);
+    CHECK(window.value() == 6);
+    window.push_back("quattro", 4);
+    CHECK(window.value() == 9);
+    CHECK(ring.getLength() == 3);
+    CHECK(ring.cbegin().key() == "due");
+
+    window.pop_front();
+    CHECK(window.value() == 7);
+    window.pop_front();
+    window.pop_front();
+    CHECK(ring.isEmpty());
+    window.pop_front();
+    window.push_back("cinque", 5);
+    CHECK(window.value() == 5);
+}
+
+TEST_CASE("window without inverse")
+{
+    bi_ring<int, string> ring;
+    ring.push_back(1, "a");
+    ring.push_back(2, "b");
+    ring.push_back(3, "c");
+
+    // attaching trims the ring to the window
+    bi_ring_window<int, string> window(ring, 2, _concatenate_window);
+    CHECK(ring.getLength() == 2);
+    CHECK(window.value() == "b-c");
+
+    window.push_back(4, "d");
+    CHECK(window.value() == "c-d");
+    window.push_back(5, "e");
+    window.push_back(6, "f");
+    CHECK(window.value() == "e-f");
+    window.pop_front();
+    CHECK(window.value() == "f");
+
+    CHECK_THROWS(bi_ring_window<int, string>(ring, 0, _concatenate_window));
+}
+
+TEST_CASE("window max matches recomputation")
+{
+    bi_ring<int, int> ring;
+    bi_ring<int, int> sums_ring;
+    bi_ring_window<int, int> maximum(ring, 16, max_info<int, int>);
+    bi_ring_window<int, int> sum(sums_ring, 16, sum_info<int, int>, subtract_info<int, int>);
+
+    mt19937 gen(7);
+    uniform_int_distribution<int> values(-1000, 1000);
+    for (int i = 0; i < 500; i++)
+    {
+        int value = values(gen);
+        maximum.push_back(i, value);
+        sum.push_back(i, value);
+        if (i % 7 == 6)
+        {
+            maximum.pop_front();
+            sum.pop_front();
+        }
+
+        int expected_max = ring.cbegin().info();
+        int expected_sum = 0;
+        ring.for_each([&](const int &, const int &info) {
+            expected_max = max(expected_max, info);
+            expected_sum += info;
+        });
+        REQUIRE(maximum.value() == expected_max);
+        REQUIRE(sum.value() == expected_sum);
+    }
+}
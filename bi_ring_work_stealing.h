@@ -0,0 +1,295 @@
+#ifndef LAB2_BI_RING_WORK_STEALING_H
+#define LAB2_BI_RING_WORK_STEALING_H
+#include "bi_ring.h"
+#include "bi_ring_channel.h"
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Task deque of one worker. The owner pushes and pops at the back of a private ring
+ * without locking. When the shared part runs dry the owner publishes the older half
+ * of its ring there, thieves take half of the shared part from its front in one
+ * splice. Only publishing, stealing and refilling from the shared part lock.
+ */
+template <typename Key, typename Info>
+class bi_ring_task_deque {
+private:
+    // private ring is published once it holds this many elements
+    static const unsigned int publish_threshold = 4;
+
+    bi_ring<Key, Info> local;
+    bi_ring<Key, Info> shared;
+    mutex lock;
+    atomic<unsigned int> shared_length;
+
+    void publish(){
+        lock_guard<mutex> guard(lock);
+        shared.splice(shared.cend(), local, local.cbegin(), local.getLength() / 2);
+        shared_length.store(shared.getLength(), memory_order_release);
+    }
+
+    void publish_if_idle(){
+        if (local.getLength() >= publish_threshold && shared_length.load(memory_order_relaxed) == 0){
+            publish();
+        }
+    }
+
+public:
+    bi_ring_task_deque() : shared_length(0) {}
+
+    bi_ring_task_deque(const bi_ring_task_deque &) = delete;
+    bi_ring_task_deque &operator=(const bi_ring_task_deque &) = delete;
+
+    /**
+     * @brief owner only: pushes element at the back
+     *
+     * @param key is the key that will be inserted
+     * @param info is info that will be inserted
+     */
+    void push_back(const Key &key, const Info &info){
+        local.push_back(key, info);
+        publish_if_idle();
+    }
+
+    /**
+     * @brief owner only: takes the most recently pushed element
+     *
+     * @param [out] key key of taken element
+     * @param [out] info info of taken element
+     * @return false if the deque is empty
+     */
+    bool pop_back(Key &key, Info &info){
+        if (local.isEmpty()){
+            if (shared_length.load(memory_order_acquire) == 0){
+                return false;
+            }
+            lock_guard<mutex> guard(lock);
+            local.splice(local.cend(), shared);
+            shared_length.store(0, memory_order_release);
+            if (local.isEmpty()){
+                return false;
+            }
+        }
+
+        auto last = --local.end();
+        key = std::move(last.key());
+        info = std::move(last.info());
+        local.pop_back();
+        publish_if_idle();
+        return true;
+    }
+
+    /**
+     * @brief owner only: adds a stolen batch as the oldest elements, batch is left empty
+     */
+    void absorb(bi_ring<Key, Info> &batch){
+        local.splice(local.cbegin(), batch);
+        publish_if_idle();
+    }
+
+    /**
+     * @brief any thread: moves the older half of the published elements to the end of out
+     *
+     * @param out ring receiving the elements
+     * @return unsigned int number of stolen elements
+     */
+    unsigned int steal(bi_ring<Key, Info> &out){
+        if (shared_length.load(memory_order_acquire) == 0){
+            return 0;
+        }
+        lock_guard<mutex> guard(lock);
+        unsigned int stolen = out.splice(out.cend(), shared, shared.cbegin(), (shared.getLength() + 1) / 2);
+        shared_length.store(shared.getLength(), memory_order_release);
+        return stolen;
+    }
+
+    /**
+     * @brief owner only: number of elements, published ones included
+     */
+    [[nodiscard]] unsigned int getLength() const{
+        return local.getLength() + shared_length.load(memory_order_acquire);
+    }
+};
+
+/**
+ * Thread pool running tasks from per-worker bi_ring_task_deques. Idle workers steal
+ * half of another worker's published tasks. Tasks spawned from outside the pool go
+ * through an injection channel.
+ */
+class bi_ring_scheduler {
+public:
+    /**
+     * Counter of unfinished tasks spawned into it, wait on it to join them.
+     */
+    class task_group {
+    private:
+        friend class bi_ring_scheduler;
+        atomic<unsigned int> pending;
+
+    public:
+        task_group() : pending(0) {}
+        task_group(const task_group &) = delete;
+        task_group &operator=(const task_group &) = delete;
+    };
+
+private:
+    typedef bi_ring_task_deque<task_group *, function<void()>> task_deque;
+    typedef bi_ring<task_group *, function<void()>> task_ring;
+
+    struct worker {
+        bi_ring_scheduler *owner;
+        unsigned int index;
+        task_deque tasks;
+        thread runner;
+    };
+
+    vector<unique_ptr<worker>> workers;
+    bi_ring_channel<task_group *, function<void()>> injected;
+    atomic<bool> stopping;
+    atomic<unsigned int> sleeping;
+    mutex idle_lock;
+    condition_variable idle;
+
+    static worker *&current(){
+        static thread_local worker *running = nullptr;
+        return running;
+    }
+
+    worker *own_worker() const{
+        worker *self = current();
+        return self != nullptr && self->owner == this ? self : nullptr;
+    }
+
+    static void run(task_group *group, function<void()> &task){
+        task();
+        if (group != nullptr){
+            group->pending.fetch_sub(1, memory_order_acq_rel);
+        }
+    }
+
+    bool steal(worker *self, task_ring &loot){
+        unsigned int start = self != nullptr ? self->index + 1 : 0;
+        for (unsigned int i = 0; i < workers.size(); i++){
+            worker *victim = workers[(start + i) % workers.size()].get();
+            if (victim != self && victim->tasks.steal(loot) != 0){
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // runs one task, returns false if there was nothing to run
+    bool run_one(worker *self){
+        task_group *group;
+        function<void()> task;
+        if (self != nullptr && self->tasks.pop_back(group, task)){
+            run(group, task);
+            return true;
+        }
+        if (injected.try_pop(group, task)){
+            run(group, task);
+            return true;
+        }
+
+        task_ring loot;
+        if (!steal(self, loot)){
+            return false;
+        }
+        auto first = loot.begin();
+        group = first.key();
+        task = std::move(first.info());
+        loot.pop_front();
+        if (self != nullptr){
+            self->tasks.absorb(loot);
+        }
+        else if (!loot.isEmpty()){
+            injected.push_back(loot);
+        }
+        run(group, task);
+        return true;
+    }
+
+    void work(worker *self){
+        current() = self;
+        while (!stopping.load(memory_order_acquire)){
+            if (run_one(self)){
+                continue;
+            }
+            unique_lock<mutex> guard(idle_lock);
+            sleeping++;
+            idle.wait_for(guard, chrono::microseconds(200));
+            sleeping--;
+        }
+        current() = nullptr;
+    }
+
+public:
+    /**
+     * @param threads number of worker threads, at least one is started
+     */
+    explicit bi_ring_scheduler(unsigned int threads) : stopping(false), sleeping(0)
+    {
+        threads = threads == 0 ? 1 : threads;
+        for (unsigned int i = 0; i < threads; i++){
+            workers.emplace_back(new worker{this, i, {}, {}});
+        }
+        for (auto &w : workers){
+            w->runner = thread(&bi_ring_scheduler::work, this, w.get());
+        }
+    }
+
+    /**
+     * Stops the workers after their current tasks, tasks not started yet are dropped.
+     */
+    ~bi_ring_scheduler()
+    {
+        stopping.store(true, memory_order_release);
+        idle.notify_all();
+        for (auto &w : workers){
+            w->runner.join();
+        }
+    }
+
+    bi_ring_scheduler(const bi_ring_scheduler &) = delete;
+    bi_ring_scheduler &operator=(const bi_ring_scheduler &) = delete;
+
+    /**
+     * @brief schedules task as part of group. From a worker the task goes to its own
+     * deque, from other threads to the injection channel.
+     */
+    void spawn(task_group &group, function<void()> task){
+        group.pending.fetch_add(1, memory_order_relaxed);
+        if (worker *self = own_worker()){
+            self->tasks.push_back(&group, std::move(task));
+        }
+        else {
+            injected.push_back(&group, std::move(task));
+        }
+        if (sleeping.load(memory_order_relaxed) != 0){
+            idle.notify_one();
+        }
+    }
+
+    /**
+     * @brief waits until every task of group finished, running other tasks meanwhile
+     */
+    void wait(task_group &group){
+        worker *self = own_worker();
+        while (group.pending.load(memory_order_acquire) != 0){
+            if (!run_one(self)){
+                this_thread::yield();
+            }
+        }
+    }
+
+    [[nodiscard]] unsigned int getThreads() const{
+        return workers.size();
+    }
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "catch2/catch_test_macros.hpp"
+#include "bi_ring_work_stealing.h"
+
+TEST_CASE("task deque owner and thief")
+{
+    bi_ring_task_deque<int, string> deque;
+    int key;
+    string info;
+    CHECK(!deque.pop_back(key, info));
+
+    for (int i = 0; i < 8; i++)
+    {
+        deque.push_back(i, to_string(i));
+    }
+    CHECK(deque.getLength() == 8);
+
+    // owner works newest first
+    CHECK(deque.pop_back(key, info));
+    CHECK(key == 7);
+    CHECK(info == "7");
+
+    // thieves take the oldest published elements, half of them at once
+    bi_ring<int, string> loot;
+    unsigned int stolen = deque.steal(loot);
+    CHECK(stolen > 0);
+    CHECK(loot.getLength() == stolen);
+    CHECK(loot.cbegin().key() == 0);
+    CHECK(deque.getLength() == 7 - stolen);
+
+    // owner drains everything that was not stolen, published elements included
+    unsigned int left = 0;
+    int previous = 8;
+    while (deque.pop_back(key, info))
+    {
+        CHECK(key < previous);
+        previous = key;
+        left++;
+    }
+    CHECK(left + stolen == 7);
+
+    deque.absorb(loot);
+    CHECK(loot.isEmpty());
+    CHECK(deque.getLength() == stolen);
+    bi_ring<int, string> nothing;
+    bi_ring_task_deque<int, string> empty;
+    CHECK(empty.steal(nothing) == 0);
+}
+
+static long fib(bi_ring_scheduler &scheduler, int n)
+{
+    if (n < 12)
+    {
+        return n < 2 ? n : fib(scheduler, n - 1) + fib(scheduler, n - 2);
+    }
+    long left = 0;
+    bi_ring_scheduler::task_group group;
+    scheduler.spawn(group, [&] { left = fib(scheduler, n - 1); });
+    long right = fib(scheduler, n - 2);
+    scheduler.wait(group);
+    return left + right;
+}
+
+TEST_CASE("scheduler fork join")
+{
+    bi_ring_scheduler scheduler(4);
+    CHECK(scheduler.getThreads() == 4);
+    CHECK(fib(scheduler, 22) == 17711);
+
+    // external spawns go through the injection channel
+    atomic<int> done(0);
+    bi_ring_scheduler::task_group group;
+    for (int i = 0; i < 100; i++)
+    {
+        scheduler.spawn(group, [&] { done++; });
+    }
+    scheduler.wait(group);
+    CHECK(done == 100);
+}